@@ -0,0 +1,139 @@
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <chef/dfa/convert.hpp>
+#include <chef/dfa/dfa.hpp>
+#include <chef/dfa/jit.hpp>
+#include <chef/dfa/minimize.hpp>
+#include <chef/dfa/stats.hpp>
+#include <chef/errors.hpp>
+#include <chef/re/parse.hpp>
+#include <chef/re/to_nfa.hpp>
+
+using namespace std::literals;
+
+/*
+
+Run chef.dfa.bench, passing a regular expression and a string it matches.
+
+The string is repeated to build a large input, which is matched in full by each of the DFA
+matchers. This prints the throughput of each.
+
+Sample usage:
+
+chef.dfa.bench '((GET|POST) /(a|b|c|d|/)* HTTP/1.1 )*' 'GET /a/b/cd HTTP/1.1 '
+
+With --stats, the time and size of each construction phase are printed first.
+*/
+
+void print_usage()
+{
+	std::cerr << "Usage: chef.dfa.bench [--size=bytes] [--stats] expression sample\n";
+}
+
+namespace {
+	// Parses the byte count given to --size=.
+	auto parse_size(std::string_view text) -> std::optional<std::size_t>
+	{
+		std::size_t size;
+		auto const [end, ec] = std::from_chars(text.data(), text.data() + text.size(), size);
+		if (ec != std::errc() || end != text.data() + text.size()) return std::nullopt;
+		return size;
+	}
+
+	// The interpreter: a table walk over chef::dfa, as in re_dfa_engine.
+	bool interpret(chef::dfa const& dfa, chef::category_view accepts,
+		std::unordered_map<char, chef::symbol_type> const& symbol_map, std::string_view str)
+	{
+		chef::state_type cur = 0;
+		for (char const c : str) {
+			auto it = symbol_map.find(c);
+			if (it == symbol_map.end()) return false;
+			cur = dfa.process(cur, it->second);
+		}
+		return accepts.contains(cur);
+	}
+
+	template <typename F>
+	void run(std::string_view name, std::string_view input, F&& matches)
+	{
+		auto const start = std::chrono::steady_clock::now();
+		bool const result = matches(input);
+		std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+
+		std::cout << name << ": " << (result ? "match" : "no match") << ", "
+				  << double(input.size()) / elapsed.count() / (1 << 20) << " MiB/s\n";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::size_t size = 64 << 20;
+	bool print_stats = false;
+	int arg = 1;
+	for (; argc > arg && std::string_view(argv[arg]).starts_with("--"); ++arg) {
+		std::string_view const option = argv[arg];
+		std::optional<std::size_t> parsed;
+		if (option.starts_with("--size=")
+			&& (parsed = parse_size(option.substr("--size="sv.size())))) {
+			size = *parsed;
+		} else if (option == "--stats") {
+			print_stats = true;
+		} else {
+			print_usage();
+			return 1;
+		}
+	}
+	if (argc - arg != 2) {
+		print_usage();
+		return 1;
+	}
+
+	chef::re re;
+	try {
+		re = chef::parse_re(argv[arg]);
+	} catch (chef::construction_error const& e) {
+		std::cerr << e.what() << '\n';
+		return 1;
+	}
+
+	std::string_view const sample = argv[arg + 1];
+	if (sample.empty()) {
+		print_usage();
+		return 1;
+	}
+	std::string input;
+	input.reserve(size + sample.size());
+	while (input.size() < size) {
+		input += sample;
+	}
+
+	chef::construction_stats stats;
+	chef::construction_stats* const stats_ptr = print_stats ? &stats : nullptr;
+	auto nfa_result = chef::to_nfa(re, stats_ptr);
+	auto [dfa, categories] = chef::to_dfa(
+		nfa_result.nfa, {nfa_result.accepts}, chef::dfa_kind::complete, stats_ptr);
+	std::tie(dfa, categories) = chef::minimize(dfa, categories, stats_ptr);
+	if (print_stats) std::cout << stats;
+
+	chef::jit_dfa const native(dfa, categories[0], nfa_result.symbol_map);
+	chef::jit_dfa const table(
+		dfa, categories[0], nfa_result.symbol_map, chef::jit_mode::interpreted);
+
+	std::cout << dfa.num_states() << " states, " << input.size() << " bytes\n";
+	run("interpreter", input, [&](std::string_view str) {
+		return interpret(dfa, categories[0], nfa_result.symbol_map, str);
+	});
+	run("byte table", input, [&](std::string_view str) { return table.matches(str); });
+	if (native.is_native()) {
+		run("native", input, [&](std::string_view str) { return native.matches(str); });
+	} else {
+		std::cout << "native: unsupported on this host\n";
+	}
+}
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <chef/dfa/codegen.hpp>
+#include <chef/dfa/convert.hpp>
+#include <chef/dfa/minimize.hpp>
+#include <chef/dfa/stats.hpp>
+#include <chef/errors.hpp>
+#include <chef/re/parse.hpp>
+#include <chef/re/to_nfa.hpp>
+
+using namespace std::literals;
+
+/*
+
+Run chef.dfa.codegen, passing one or more regular expressions as arguments.
+
+This will output a C++ function which matches the expressions without any runtime construction.
+With a single expression, the function returns whether the whole input matched. With several
+expressions (a lexer specification), it returns the index of the first expression matching the
+whole input, or -1.
+
+Sample usage:
+
+chef.dfa.codegen --name=is_keyword 'if|else|while' >is_keyword.hpp
+
+chef.dfa.codegen --name=token_kind 'if' 'else' '(a|b|c)(a|b|c|0|1)*' '(0|1)(0|1)*' >lexer.hpp
+
+With --stats, the time and size of each construction phase are written to stderr.
+*/
+
+void print_usage()
+{
+	std::cerr << "Usage: chef.dfa.codegen [--name=function_name] [--stats] expression...\n";
+}
+
+int main(int argc, char** argv)
+{
+	std::string function_name = "match";
+	bool print_stats = false;
+	std::vector<chef::re> res;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string_view const arg = argv[i];
+		if (arg.starts_with("--name=")) {
+			function_name = arg.substr("--name="sv.size());
+			continue;
+		}
+		if (arg == "--stats") {
+			print_stats = true;
+			continue;
+		}
+
+		try {
+			res.push_back(chef::parse_re(arg));
+		} catch (chef::construction_error const& e) {
+			std::cerr << e.what() << '\n';
+			return 1;
+		}
+	}
+
+	if (res.empty() || function_name.empty()) {
+		print_usage();
+		return 1;
+	}
+
+	chef::construction_stats stats;
+	chef::construction_stats* const stats_ptr = print_stats ? &stats : nullptr;
+	auto nfa_result = chef::to_nfa(res, stats_ptr);
+	auto [dfa, categories] = chef::to_dfa(
+		nfa_result.nfa, nfa_result.categories, chef::dfa_kind::complete, stats_ptr);
+	std::tie(dfa, categories) = chef::minimize(dfa, categories, stats_ptr);
+	if (print_stats) std::cerr << stats;
+
+	std::cout << chef::to_cpp(dfa, categories, nfa_result.symbol_map, function_name);
+}
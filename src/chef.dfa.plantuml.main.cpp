@@ -1,24 +1,28 @@
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <unordered_set>
-#include <vector>
 
 #include <chef/_/fwd.hpp>
 #include <chef/_/ranges.hpp>
 #include <chef/dfa/convert.hpp>
 #include <chef/dfa/dfa.hpp>
+#include <chef/dfa/edge_list.hpp>
 #include <chef/dfa/minimize.hpp>
 #include <chef/dfa/nfa.hpp>
 #include <chef/dfa/plantuml.hpp>
+#include <chef/dfa/stats.hpp>
+#include <chef/errors.hpp>
 
 using namespace std::literals;
 
 /*
 
-Run chef.dfa.plantuml, passing the NFA description into stdin.
-Specify by the single commandline argument whether you wish the nfa or converted dfa to be printed.
+Run chef.dfa.plantuml, passing the NFA description into stdin, or naming a file with --input.
+The description is an edge list of `from to symbol` lines, where symbol 0 is epsilon.
+Specify by the commandline argument whether you wish the nfa or converted dfa to be printed.
 
 This will output a UML state diagram in plantuml format, which can be piped into plantuml.
 
@@ -33,67 +37,82 @@ printf '0 1 2\n1 0 1\n2 0 0\n2 1 1\n1 0 0\n0 2 0\n' | chef.dfa.plantuml --minimi
 // Wikipedia example:
 printf '0 1 0\n0 2 1\n1 0 0\n1 3 1\n2 4 0\n2 5 1\n3 4 0\n3 5 1\n4 4 0\n4 5 1\n5 5 0\n5 5 1\n' | \
     chef.dfa.plantuml --minimize --final=2,3,4 dfa | java -jar plantuml.jar -pipe >dfa.png
+
+chef.dfa.plantuml --input=edges.txt nfa | java -jar plantuml.jar -pipe >nfa.png
+
+With --stats, the time and size of each construction phase are written to stderr.
 */
 
 void print_usage()
 {
-	std::cerr << "Usage: chef.dfa.plantuml [--minimize] ['--final=1,4,2'] [dfa|nfa]\n";
+	std::cerr << "Usage: chef.dfa.plantuml [--input=edges.txt] [--minimize] [--stats] "
+				 "['--final=1,4,2'] [dfa|nfa]\n";
 }
 
 int main(int argc, char** argv)
 {
 	std::unordered_set<chef::state_type> final_states;
-	bool is_dfa = false;
+	std::string input_path;
+	std::string_view kind;
 	bool minimize = false;
-	if (argc != 2) {
-		if (argc == 4 && argv[1] == "--minimize"sv
-			&& std::string_view(argv[2]).starts_with("--final=")) {
+	bool print_stats = false;
+	for (int i = 1; i < argc; ++i) {
+		std::string_view const arg = argv[i];
+		if (arg == "--minimize") {
 			minimize = true;
-			is_dfa = true;
-			if (argv[3] != "dfa"sv) {
-				std::cerr << "Only DFAs are minimizable\n";
-				return 1;
-			}
-			std::string_view finals = argv[2];
+		} else if (arg == "--stats") {
+			print_stats = true;
+		} else if (arg.starts_with("--final=")) {
+			std::string_view finals = arg;
 			finals.remove_prefix("--final="sv.size());
 
 			for (auto&& section : std::ranges::views::split(finals, ',')) {
 				auto com_section = std::ranges::views::common(CHEF_FWD(section));
 				final_states.insert(std::stoi(std::string(com_section.begin(), com_section.end())));
 			}
+		} else if (arg.starts_with("--input=")) {
+			input_path = arg.substr("--input="sv.size());
+		} else if (kind.empty() && (arg == "dfa" || arg == "nfa")) {
+			kind = arg;
 		} else {
 			print_usage();
 			return 1;
 		}
-	} else {
-		if (argv[1] != "dfa"sv && argv[1] != "nfa"sv) {
-			print_usage();
-			return 1;
-		}
-		is_dfa = argv[1] == "dfa"sv;
+	}
+	if (kind.empty()) {
+		print_usage();
+		return 1;
+	}
+	bool const is_dfa = kind == "dfa";
+	if (minimize && !is_dfa) {
+		std::cerr << "Only DFAs are minimizable\n";
+		return 1;
 	}
 
-	std::vector<chef::fa_edge> edge_list;
-	std::unordered_set<unsigned int> states;
-	std::unordered_set<unsigned int> symbols;
-
-	unsigned int from, symbol, to;
-
-	while (std::cin >> from >> to >> symbol) {
-		edge_list.emplace_back(from, to, symbol);
-		states.insert(from);
-		states.insert(to);
-		symbols.insert(symbol);
+	chef::edge_list edges;
+	try {
+		if (input_path.empty()) {
+			std::string const text(std::istreambuf_iterator<char>(std::cin), {});
+			edges = chef::parse_edge_list(text);
+		} else {
+			edges = chef::load_edge_list(input_path);
+		}
+	} catch (chef::construction_error const& e) {
+		std::cerr << e.what() << '\n';
+		return 1;
 	}
 
-	auto nfa = chef::nfa(static_cast<chef::state_type>(states.size()),
-		static_cast<chef::symbol_type>(symbols.size()), edge_list);
+	auto const nfa = edges.to_nfa();
 
 	if (is_dfa) {
-		auto [dfa, categories] = chef::to_dfa(nfa, {final_states});
+		chef::construction_stats stats;
+		chef::construction_stats* const stats_ptr = print_stats ? &stats : nullptr;
+		auto [dfa, categories]
+			= chef::to_dfa(nfa, {final_states}, chef::dfa_kind::complete, stats_ptr);
 		if (minimize) {
-			std::tie(dfa, categories) = chef::minimize(dfa, categories);
+			std::tie(dfa, categories) = chef::minimize(dfa, categories, stats_ptr);
 		}
+		if (print_stats) std::cerr << stats;
 
 		std::unordered_map<chef::state_type, std::string> labels;
 		assert(categories.size() == 1);
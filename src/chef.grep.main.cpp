@@ -0,0 +1,316 @@
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <chef/_/fwd.hpp>
+#include <chef/dfa/convert.hpp>
+#include <chef/dfa/jit.hpp>
+#include <chef/dfa/minimize.hpp>
+#include <chef/errors.hpp>
+#include <chef/re/literal.hpp>
+#include <chef/re/parse.hpp>
+#include <chef/re/to_nfa.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std::literals;
+
+/*
+
+Run chef.grep, passing a regular expression and the files to search. With no files, stdin is
+searched.
+
+This prints each line containing a match of the expression, in the order of the files, prefixed
+by the file name when there are several files. As with grep, the exit status is 0 if a line
+matched, 1 if none did, and 2 if a file couldn't be read.
+
+The files are mapped into memory and split into chunks of whole lines, which are searched in
+parallel. Lines are found through a literal which every match contains, if there is one, and
+are then matched with the compiled DFA.
+
+Sample usage:
+
+chef.grep 'GET /(a|b)*' access.log
+
+chef.grep --threads=1 --no-prefilter 'ERROR' *.log >/dev/null
+
+With --no-prefilter, every line is matched with the DFA, which is useful when benchmarking it.
+*/
+
+void print_usage()
+{
+	std::cerr << "Usage: chef.grep [--threads=N] [--chunk-size=bytes] [--no-prefilter] "
+				 "expression [file...]\n";
+}
+
+namespace {
+	// Parses the count given to an option, at least 1.
+	auto parse_count(std::string_view text) -> std::optional<std::size_t>
+	{
+		std::size_t count;
+		auto const [end, ec] = std::from_chars(text.data(), text.data() + text.size(), count);
+		if (ec != std::errc() || end != text.data() + text.size()) return std::nullopt;
+		return std::max<std::size_t>(1, count);
+	}
+
+	// A file which couldn't be read.
+	class file_error : public std::runtime_error {
+	public:
+		using std::runtime_error::runtime_error;
+	};
+
+	// A file's text, kept alive (e.g. mapped) for as long as any chunk of it is being searched.
+	struct input {
+		std::string name;
+		std::string_view text;
+		std::shared_ptr<void const> owner;
+	};
+
+	auto map_file(std::string const& path) -> input
+	{
+		int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) throw file_error("Cannot open " + path);
+
+		struct ::stat st;
+		if (::fstat(fd, &st) != 0) {
+			::close(fd);
+			throw file_error("Cannot read " + path);
+		}
+		auto const size = static_cast<std::size_t>(st.st_size);
+		if (size == 0) {
+			::close(fd);
+			return input{.name = path, .text = {}, .owner = nullptr};
+		}
+
+		void* const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (data == MAP_FAILED) throw file_error("Cannot map " + path);
+		::madvise(data, size, MADV_SEQUENTIAL);
+
+		return input{
+			.name = path,
+			.text = std::string_view(static_cast<char const*>(data), size),
+			.owner = std::shared_ptr<void const>(
+				data, [size](void const* data) { ::munmap(const_cast<void*>(data), size); }),
+		};
+	}
+
+	auto read_stdin() -> input
+	{
+		auto text = std::make_shared<std::string const>(std::istreambuf_iterator<char>(std::cin),
+			std::istreambuf_iterator<char>());
+		return input{.name = "(standard input)", .text = *text, .owner = text};
+	}
+
+	class searcher {
+	private:
+		chef::jit_dfa dfa_;
+		std::string literal_;
+
+	public:
+		// The DFA accepts any line with a match of `re` somewhere in it.
+		explicit searcher(chef::re const& re, bool prefilter)
+			: dfa_(compile(re))
+			, literal_(prefilter ? chef::required_literal(re) : "")
+		{ }
+
+		// Appends the matching lines of the text to `out`, each prefixed by `prefix`.
+		void search(std::string_view text, std::string_view prefix, std::string& out) const
+		{
+			std::size_t first = 0;
+			while (first < text.size()) {
+				if (!literal_.empty()) {
+					std::size_t const found = text.find(literal_, first);
+					if (found == std::string_view::npos) return;
+					std::size_t const newline = text.rfind('\n', found);
+					first = newline == std::string_view::npos ? 0 : std::max(first, newline + 1);
+				}
+
+				std::size_t last = text.find('\n', first);
+				if (last == std::string_view::npos) last = text.size();
+
+				std::string_view const line = text.substr(first, last - first);
+				if (dfa_.matches(line)) {
+					out += prefix;
+					out += line;
+					out += '\n';
+				}
+				first = last + 1;
+			}
+		}
+
+	private:
+		static auto compile(chef::re const& re) -> chef::jit_dfa
+		{
+			// Anything, including characters the expression never mentions.
+			chef::re const any = ~chef::re();
+			auto const nfa_result = chef::to_nfa(any << re << any);
+			auto const [dfa, categories]
+				= chef::to_dfa(nfa_result.nfa, {nfa_result.accepts}, chef::dfa_kind::complete);
+			auto const [min_dfa, min_categories] = chef::minimize(dfa, categories);
+			return chef::jit_dfa(min_dfa, min_categories[0], nfa_result.symbol_map);
+		}
+	};
+
+	// Runs tasks on a fixed set of threads, in the order they were submitted.
+	class thread_pool {
+	private:
+		std::mutex mutex_;
+		std::condition_variable_any ready_;
+		std::deque<std::packaged_task<std::string()>> tasks_;
+		std::vector<std::jthread> threads_;
+
+	public:
+		explicit thread_pool(std::size_t num_threads)
+		{
+			threads_.reserve(num_threads);
+			for (std::size_t i = 0; i < num_threads; ++i) {
+				threads_.emplace_back([this](std::stop_token stop) { work(stop); });
+			}
+		}
+
+		~thread_pool()
+		{
+			for (auto& thread : threads_) {
+				thread.request_stop();
+			}
+		}
+
+		auto submit(std::function<std::string()> f) -> std::future<std::string>
+		{
+			std::packaged_task<std::string()> task(CHEF_MOVE(f));
+			auto result = task.get_future();
+			{
+				std::scoped_lock const lock(mutex_);
+				tasks_.push_back(CHEF_MOVE(task));
+			}
+			ready_.notify_one();
+			return result;
+		}
+
+	private:
+		void work(std::stop_token stop)
+		{
+			while (true) {
+				std::packaged_task<std::string()> task;
+				{
+					std::unique_lock lock(mutex_);
+					if (!ready_.wait(lock, stop, [&] { return !tasks_.empty(); })) return;
+					task = CHEF_MOVE(tasks_.front());
+					tasks_.pop_front();
+				}
+				task();
+			}
+		}
+	};
+}
+
+int main(int argc, char** argv)
+{
+	std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency());
+	std::size_t chunk_size = 4 << 20;
+	bool prefilter = true;
+	int arg = 1;
+	for (; argc > arg && std::string_view(argv[arg]).starts_with("--"); ++arg) {
+		std::string_view const option = argv[arg];
+		std::optional<std::size_t> count;
+		if (option.starts_with("--threads=")
+			&& (count = parse_count(option.substr("--threads="sv.size())))) {
+			num_threads = *count;
+		} else if (option.starts_with("--chunk-size=")
+			&& (count = parse_count(option.substr("--chunk-size="sv.size())))) {
+			chunk_size = *count;
+		} else if (option == "--no-prefilter") {
+			prefilter = false;
+		} else {
+			print_usage();
+			return 2;
+		}
+	}
+	if (argc == arg) {
+		print_usage();
+		return 2;
+	}
+
+	std::unique_ptr<searcher const> search;
+	try {
+		search = std::make_unique<searcher const>(chef::parse_re(argv[arg]), prefilter);
+	} catch (chef::construction_error const& e) {
+		std::cerr << e.what() << '\n';
+		return 2;
+	}
+	std::vector<std::string> const paths(argv + arg + 1, argv + argc);
+	bool const with_names = paths.size() > 1;
+
+	std::ios_base::sync_with_stdio(false);
+	bool any_matched = false;
+	bool any_failed = false;
+
+	// Chunks are searched in parallel, but their results are written in order. Only a few
+	// chunks are in flight at once, so only a few files are mapped at once.
+	thread_pool pool(num_threads);
+	std::size_t const max_pending = 4 * num_threads;
+	std::deque<std::future<std::string>> pending;
+	auto const write_oldest = [&] {
+		std::string const lines = pending.front().get();
+		pending.pop_front();
+		any_matched = any_matched || !lines.empty();
+		std::cout.write(lines.data(), static_cast<std::streamsize>(lines.size()));
+	};
+
+	auto const submit = [&](input const& file) {
+		std::string const prefix = with_names ? file.name + ':' : "";
+		std::string_view const text = file.text;
+
+		// Each chunk ends just after a newline, so lines aren't split.
+		for (std::size_t first = 0; first < text.size();) {
+			std::size_t last = first + std::min(chunk_size, text.size() - first);
+			last = std::min(text.find('\n', last - 1), text.size() - 1) + 1;
+
+			if (pending.size() == max_pending) write_oldest();
+			pending.push_back(pool.submit([&search, file, prefix, first, last] {
+				std::string out;
+				search->search(file.text.substr(first, last - first), prefix, out);
+				return out;
+			}));
+			first = last;
+		}
+	};
+
+	if (paths.empty()) {
+		submit(read_stdin());
+	}
+	for (std::string const& path : paths) {
+		try {
+			submit(map_file(path));
+		} catch (file_error const& e) {
+			// Write out what came before first, so the error is in order.
+			while (!pending.empty()) write_oldest();
+			std::cout.flush();
+			std::cerr << "chef.grep: " << e.what() << '\n';
+			any_failed = true;
+		}
+	}
+	while (!pending.empty()) write_oldest();
+	std::cout.flush();
+
+	if (any_failed) return 2;
+	return any_matched ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// The heap memory held by standard containers, not counting the container object itself or
+// what its elements hold in turn. Node-based containers are estimated from the size of their
+// nodes, as the allocator's own overhead can't be seen.
+namespace chef::detail {
+	template <typename T>
+	auto heap_bytes(std::vector<T> const& values) -> std::size_t
+	{
+		return values.capacity() * sizeof(T);
+	}
+
+	inline auto heap_bytes(std::vector<bool> const& values) -> std::size_t
+	{
+		return values.capacity() / 8;
+	}
+
+	inline auto heap_bytes(std::string const& str) -> std::size_t
+	{
+		// Short strings are kept inside the object.
+		return str.capacity() > std::string().capacity() ? str.capacity() + 1 : 0;
+	}
+
+	template <typename Key, typename T, typename... Rest>
+	auto heap_bytes(std::map<Key, T, Rest...> const& map) -> std::size_t
+	{
+		// Each node has three links and a colour besides its value.
+		using value_type = typename std::map<Key, T, Rest...>::value_type;
+		return map.size() * (sizeof(value_type) + 4 * sizeof(void*));
+	}
+
+	template <typename Key, typename T, typename... Rest>
+	auto heap_bytes(std::unordered_map<Key, T, Rest...> const& map) -> std::size_t
+	{
+		// A bucket array, and nodes with a link and possibly a cached hash besides the value.
+		using value_type = typename std::unordered_map<Key, T, Rest...>::value_type;
+		return map.bucket_count() * sizeof(void*)
+			+ map.size() * (sizeof(value_type) + 2 * sizeof(void*));
+	}
+
+	template <typename T, typename... Rest>
+	auto heap_bytes(std::unordered_set<T, Rest...> const& set) -> std::size_t
+	{
+		return set.bucket_count() * sizeof(void*) + set.size() * (sizeof(T) + 2 * sizeof(void*));
+	}
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <stop_token>
+
+#include <chef/errors.hpp>
+
+namespace chef {
+	// Limits on the work done for one construction or match. The limits are checked as the
+	// work goes, and going over one throws a chef::construction_budget_error from a
+	// construction, or a chef::evaluation_budget_error from a match.
+	//
+	// The default budget is unlimited.
+	struct budget {
+		static constexpr std::size_t unlimited = std::numeric_limits<std::size_t>::max();
+
+		// The most states of a DFA under construction.
+		std::size_t max_states = unlimited;
+		// The most bytes of the construction's working data (as chef::construction_stats counts
+		// them).
+		std::size_t max_bytes = unlimited;
+		// The most steps of a matching engine, such as the states a backtracking engine visits or
+		// the derivatives the derivative engine takes.
+		std::size_t max_steps = unlimited;
+		// The most wall time, from the start of the construction or match.
+		std::chrono::nanoseconds max_time = std::chrono::nanoseconds::max();
+		// Cancels the work from another thread.
+		std::stop_token stop = {};
+	};
+
+	namespace detail {
+		// Tracks the work done against a budget. Time and cancellation are only checked every
+		// `check_interval` calls, as they are slower to look at.
+		class budget_meter {
+		private:
+			static constexpr std::size_t check_interval = 256;
+
+			chef::budget const* budget_;
+			std::chrono::steady_clock::time_point deadline_;
+			bool has_deadline_;
+			std::size_t calls_ = 0;
+			std::size_t steps_ = 0;
+
+		public:
+			explicit budget_meter(chef::budget const& budget)
+				: budget_(&budget)
+				, has_deadline_(budget.max_time != std::chrono::nanoseconds::max())
+			{
+				if (has_deadline_) deadline_ = std::chrono::steady_clock::now() + budget.max_time;
+			}
+
+			// For constructions: checks the size so far.
+			void check_size(std::size_t states, std::size_t bytes)
+			{
+				if (states > budget_->max_states) {
+					throw chef::construction_budget_error(
+						chef::budget_limit::states, "Too many DFA states for the budget");
+				}
+				if (bytes > budget_->max_bytes) {
+					throw chef::construction_budget_error(
+						chef::budget_limit::bytes, "Too much memory for the budget");
+				}
+				check_interrupt<chef::construction_budget_error>();
+			}
+
+			// For matches: counts one more step.
+			void step()
+			{
+				if (++steps_ > budget_->max_steps) {
+					throw chef::evaluation_budget_error(
+						chef::budget_limit::steps, "Too many matching steps for the budget");
+				}
+				check_interrupt<chef::evaluation_budget_error>();
+			}
+
+		private:
+			template <typename Error>
+			void check_interrupt()
+			{
+				if (++calls_ % check_interval != 0) return;
+				if (has_deadline_ && std::chrono::steady_clock::now() > deadline_) {
+					throw Error(chef::budget_limit::time, "Out of time for the budget");
+				}
+				if (budget_->stop.stop_requested()) {
+					throw Error(chef::budget_limit::cancelled, "Cancelled");
+				}
+			}
+		};
+	}
+}
@@ -3,7 +3,9 @@
 #include <map>
 #include <set>
 #include <string>
+#include <variant>
 
+#include <chef/_/memory.hpp>
 #include <chef/cfg/cfg.hpp>
 #include <chef/errors.hpp>
 
@@ -40,4 +42,23 @@ namespace chef {
 	ll1_table::ll1_table(const cfg& grammar)
 		: ll1_table(compute_ll1_table(grammar))
 	{ }
+
+	ll1_memory_usage ll1_table::memory_usage() const
+	{
+		ll1_memory_usage result;
+		result.rows = detail::heap_bytes(table_);
+		for (const auto& [var, row] : table_) {
+			result.rows += detail::heap_bytes(var.value);
+			result.entries += detail::heap_bytes(row);
+			for (const auto& [token, seq] : row) {
+				result.expansions += detail::heap_bytes(seq.value);
+				for (const cfg_seq::value_type& item : seq) {
+					if (const auto* item_var = std::get_if<cfg_var>(&item)) {
+						result.expansions += detail::heap_bytes(item_var->value);
+					}
+				}
+			}
+		}
+		return result;
+	}
 }
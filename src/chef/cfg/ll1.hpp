@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <iterator>
 #include <map>
 #include <ranges>
@@ -30,6 +31,21 @@ namespace chef {
 		};
 	}
 
+	// The heap bytes held by a chef::ll1_table, by component.
+	struct ll1_memory_usage {
+		// The row of each variable, with the variable's name.
+		std::size_t rows = 0;
+		// The (token, expansion) entries of the rows.
+		std::size_t entries = 0;
+		// The variables and tokens of the expansions.
+		std::size_t expansions = 0;
+
+		std::size_t total() const
+		{
+			return rows + entries + expansions;
+		}
+	};
+
 	// This table tells us how to expand the LL(1) parsing state given the next token of input.
 	class ll1_table {
 	private:
@@ -42,6 +58,8 @@ namespace chef {
 
 		explicit ll1_table(const cfg& grammar);
 
+		ll1_memory_usage memory_usage() const;
+
 		// Expand the (variable, token) sequence into the provided container.
 		//
 		// Note that the expanded cfg_seq will be in reverse order, like a stack.
@@ -5,6 +5,7 @@
 #include <ranges>
 #include <sstream>
 #include <stack>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -107,6 +108,25 @@ TEST_CASE("ll1_table::parse works")
 	}
 }
 
+TEST_CASE("ll1_table reports its memory usage")
+{
+	const std::string long_name(100, 'S');
+	const ll1_table small({{"S"_var, {{0_tok, {{0_tok}}}}}});
+	const ll1_table large({
+		{cfg_var{long_name},
+			{
+				{0_tok, {{0_tok, cfg_var{long_name}}}},
+				{1_tok, {{1_tok}}},
+			}},
+	});
+
+	const auto usage = large.memory_usage();
+	CHECK(usage.rows > long_name.size());
+	CHECK(usage.entries > small.memory_usage().entries);
+	CHECK(usage.expansions > long_name.size());
+	CHECK(usage.total() == usage.rows + usage.entries + usage.expansions);
+}
+
 TEST_CASE("ll1_table from CFG works")
 {
 	SECTION("tiny CFG")
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <unordered_set>
+#include <vector>
+
+#include <chef/_/fwd.hpp>
+#include <chef/_/memory.hpp>
+#include <chef/dfa/fa.hpp>
+
+namespace chef {
+	class category_view;
+
+	// Whether the outcome of a match is already decided once the DFA reaches a state.
+	enum class sink_kind : std::uint8_t {
+		// The remaining input still matters.
+		none,
+		// No state of any category is reachable; the match can never succeed.
+		dead,
+		// Every reachable state is in exactly this state's categories, of which there is at
+		// least one; the match succeeds whatever the remaining input is.
+		accept_forever,
+	};
+
+	// The categories (e.g. final states, token types) of each state of a DFA, as one row of bits
+	// per state, so checking a state's category is a single load.
+	//
+	// A partial DFA's dead state, or any other state past num_states(), is in no category.
+	//
+	// The DFA constructions also mark the sink_kind of each state (see chef::mark_sinks()), so
+	// matchers can stop early without analysing the DFA again.
+	class state_categories {
+	private:
+		std::vector<std::uint64_t> bits_;
+		state_type num_states_ = 0;
+		std::size_t num_categories_ = 0;
+		// 64-bit words per state.
+		std::size_t row_size_ = 0;
+		// Indexed by state. Empty until marked.
+		std::vector<chef::sink_kind> sinks_;
+
+	public:
+		state_categories() = default;
+
+		// No state is in any of the categories.
+		explicit state_categories(state_type num_states, std::size_t num_categories)
+			: bits_(num_states * ((num_categories + 63) / 64))
+			, num_states_(num_states)
+			, num_categories_(num_categories)
+			, row_size_((num_categories + 63) / 64)
+		{ }
+
+		// Category `i` has the states of `categories[i]`.
+		explicit state_categories(state_type num_states,
+			std::vector<std::unordered_set<state_type>> const& categories)
+			: state_categories(num_states, categories.size())
+		{
+			for (std::size_t category = 0; category < categories.size(); ++category) {
+				for (state_type const state : categories[category]) {
+					insert(category, state);
+				}
+			}
+		}
+
+		auto num_states() const -> state_type
+		{
+			return num_states_;
+		}
+
+		auto num_categories() const -> std::size_t
+		{
+			return num_categories_;
+		}
+
+		// As num_categories(), for use like a std::vector of categories.
+		auto size() const -> std::size_t
+		{
+			return num_categories_;
+		}
+
+		bool contains(std::size_t category, state_type state) const
+		{
+			assert(category < num_categories_);
+			if (state >= num_states_) return false;
+			return (bits_[state * row_size_ + category / 64] >> (category % 64)) & 1;
+		}
+
+		void insert(std::size_t category, state_type state)
+		{
+			assert(category < num_categories_);
+			assert(state < num_states_);
+			bits_[state * row_size_ + category / 64] |= std::uint64_t(1) << (category % 64);
+			sinks_.clear();
+		}
+
+		// Whether the sink kinds of the states have been marked.
+		bool has_sinks() const
+		{
+			return !sinks_.empty() || num_states_ == 0;
+		}
+
+		// The sink kind of the state, or sink_kind::none if the sinks have not been marked.
+		// States past num_states() are dead.
+		auto sink(state_type state) const -> chef::sink_kind
+		{
+			if (!has_sinks()) return chef::sink_kind::none;
+			if (state >= num_states_) return chef::sink_kind::dead;
+			return sinks_[state];
+		}
+
+		// Marks the sink kind of each state, indexed by state; see chef::mark_sinks().
+		void set_sinks(std::vector<chef::sink_kind> sinks)
+		{
+			assert(sinks.size() == num_states_);
+			sinks_ = CHEF_MOVE(sinks);
+		}
+
+		// The first category of the state, which has priority (e.g. among a lexer's tokens).
+		auto first(state_type state) const -> std::optional<std::size_t>
+		{
+			if (state >= num_states_) return std::nullopt;
+			for (std::size_t word = 0; word < row_size_; ++word) {
+				std::uint64_t const bits = bits_[state * row_size_ + word];
+				if (bits != 0) return word * 64 + std::countr_zero(bits);
+			}
+			return std::nullopt;
+		}
+
+		// The state's categories as a bitset.
+		auto row(state_type state) const -> std::span<std::uint64_t const>
+		{
+			assert(state < num_states_);
+			return std::span(bits_).subspan(state * row_size_, row_size_);
+		}
+
+		// The number of 64-bit words in a row.
+		auto row_size() const -> std::size_t
+		{
+			return row_size_;
+		}
+
+		// Adds the state to every category in `categories`, a row of another table with the same
+		// number of categories.
+		void insert_all(state_type state, std::span<std::uint64_t const> categories)
+		{
+			assert(state < num_states_);
+			assert(categories.size() == row_size_);
+			std::uint64_t* const row = bits_.data() + state * row_size_;
+			for (std::size_t word = 0; word < row_size_; ++word) {
+				row[word] |= categories[word];
+			}
+			sinks_.clear();
+		}
+
+		// The heap bytes held by the table.
+		auto memory_usage() const -> std::size_t
+		{
+			return detail::heap_bytes(bits_) + detail::heap_bytes(sinks_);
+		}
+
+		// Whether the states are in exactly the same categories.
+		bool same_categories(state_type lhs, state_type rhs) const
+		{
+			return std::ranges::equal(row(lhs), row(rhs));
+		}
+
+		category_view operator[](std::size_t category) const;
+
+		// The sink marks are derived from the categories, so they are not compared.
+		bool operator==(state_categories const& rhs) const
+		{
+			return num_states_ == rhs.num_states_ && num_categories_ == rhs.num_categories_
+				&& bits_ == rhs.bits_;
+		}
+	};
+
+	// The states of one category of a chef::state_categories, which must outlive the view.
+	class category_view {
+	private:
+		state_categories const* categories_;
+		std::size_t category_;
+
+	public:
+		class iterator {
+		private:
+			state_categories const* categories_ = nullptr;
+			std::size_t category_ = 0;
+			state_type state_ = 0;
+
+		public:
+			using value_type = state_type;
+			using difference_type = std::ptrdiff_t;
+
+			iterator() = default;
+
+			explicit iterator(category_view const& view, state_type state)
+				: categories_(view.categories_)
+				, category_(view.category_)
+				, state_(state)
+			{
+				skip();
+			}
+
+			auto operator*() const -> state_type
+			{
+				return state_;
+			}
+
+			auto operator++() -> iterator&
+			{
+				++state_;
+				skip();
+				return *this;
+			}
+
+			auto operator++(int) -> iterator
+			{
+				iterator result = *this;
+				++*this;
+				return result;
+			}
+
+			bool operator==(iterator const& rhs) const
+			{
+				return state_ == rhs.state_;
+			}
+
+		private:
+			void skip()
+			{
+				while (state_ < categories_->num_states()
+					&& !categories_->contains(category_, state_)) {
+					++state_;
+				}
+			}
+		};
+
+		explicit category_view(state_categories const& categories, std::size_t category)
+			: categories_(&categories)
+			, category_(category)
+		{
+			assert(category < categories.num_categories());
+		}
+
+		bool contains(state_type state) const
+		{
+			return categories_->contains(category_, state);
+		}
+
+		// Whether the sink kinds of the states have been marked.
+		bool has_sinks() const
+		{
+			return categories_->has_sinks();
+		}
+
+		// The sink kind of the state for this category alone, or sink_kind::none if the sinks
+		// have not been marked.
+		auto sink(state_type state) const -> chef::sink_kind
+		{
+			if (categories_->sink(state) == chef::sink_kind::none) return chef::sink_kind::none;
+			// The state's categories can't change, so neither can whether it is in this one.
+			return contains(state) ? chef::sink_kind::accept_forever : chef::sink_kind::dead;
+		}
+
+		// The states of the category, in order. Iterating takes time in the number of states.
+		auto begin() const -> iterator
+		{
+			return iterator(*this, 0);
+		}
+
+		auto end() const -> iterator
+		{
+			return iterator(*this, categories_->num_states());
+		}
+
+		auto size() const -> std::size_t
+		{
+			return static_cast<std::size_t>(std::distance(begin(), end()));
+		}
+
+		bool empty() const
+		{
+			return begin() == end();
+		}
+	};
+
+	inline category_view state_categories::operator[](std::size_t category) const
+	{
+		return category_view(*this, category);
+	}
+}
@@ -0,0 +1,62 @@
+#include <chef/dfa/categories.hpp>
+
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("state categories store a row of bits per state")
+{
+	auto const categories = chef::state_categories(5, {{1, 3}, {3}, {}});
+
+	CHECK(categories.num_states() == 5);
+	CHECK(categories.num_categories() == 3);
+	CHECK(categories.contains(0, 1));
+	CHECK(categories.contains(0, 3));
+	CHECK(categories.contains(1, 3));
+	CHECK_FALSE(categories.contains(1, 1));
+	CHECK_FALSE(categories.contains(2, 3));
+	// Like a partial DFA's dead state.
+	CHECK_FALSE(categories.contains(0, 5));
+
+	CHECK(categories.first(1) == 0u);
+	CHECK(categories.first(3) == 0u);
+	CHECK(categories.first(0) == std::nullopt);
+	CHECK(categories.first(5) == std::nullopt);
+
+	CHECK(categories.same_categories(0, 2));
+	CHECK_FALSE(categories.same_categories(1, 3));
+
+	auto const view = categories[0];
+	CHECK(std::vector(view.begin(), view.end()) == std::vector<chef::state_type>{1, 3});
+	CHECK(view.size() == 2);
+	CHECK(categories[2].empty());
+}
+
+TEST_CASE("state categories span several words")
+{
+	chef::state_categories categories(3, 130);
+	categories.insert(129, 1);
+	categories.insert(64, 2);
+	categories.insert(70, 2);
+
+	CHECK(categories.row_size() == 3);
+	CHECK(categories.first(1) == 129u);
+	CHECK(categories.first(2) == 64u);
+	CHECK(categories.contains(70, 2));
+	CHECK_FALSE(categories.contains(129, 2));
+
+	chef::state_categories copy(3, 130);
+	copy.insert_all(0, categories.row(2));
+	copy.insert_all(0, categories.row(1));
+	CHECK(copy.contains(64, 0));
+	CHECK(copy.contains(70, 0));
+	CHECK(copy.contains(129, 0));
+	CHECK(copy.first(0) == 64u);
+	CHECK(copy != categories);
+}
+
+TEST_CASE("state categories report their memory usage")
+{
+	CHECK(chef::state_categories(100, 1).memory_usage() == 100 * sizeof(std::uint64_t));
+	CHECK(chef::state_categories(100, 65).memory_usage() == 200 * sizeof(std::uint64_t));
+}
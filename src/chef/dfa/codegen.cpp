@@ -0,0 +1,131 @@
+#include "./codegen.hpp"
+
+#include <array>
+#include <cctype>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+
+#include <chef/dfa/sinks.hpp>
+
+namespace chef {
+	namespace {
+		// What a state does on an input byte: go to another state, or reject.
+		using byte_action = std::optional<chef::state_type>;
+
+		auto write_byte(std::ostream& out, unsigned int byte) -> std::ostream&
+		{
+			out << byte;
+			if (byte < 0x80 && std::isprint(static_cast<int>(byte)) && byte != '\\'
+				&& byte != '/' && byte != '*')
+			{
+				out << " /* '" << static_cast<char>(byte) << "' */";
+			}
+			return out;
+		}
+	}
+
+	auto to_cpp::do_write(std::ostream& out, to_cpp const& value) -> std::ostream&
+	{
+		auto const& dfa = *value.dfa;
+		auto const& categories = *value.categories;
+		bool const is_single = categories.size() == 1;
+
+		std::string const reject = is_single ? "false" : "-1";
+
+		// The result for each state if the input ends there.
+		std::vector<std::string> results(dfa.num_states(), reject);
+		for (chef::state_type const state : dfa.states()) {
+			if (auto const cat = categories.first(state)) {
+				results[state] = is_single ? "true" : std::to_string(*cat);
+			}
+		}
+
+		// Nothing is reachable from a dead state, so transitions into one reject right away.
+		std::vector<chef::sink_kind> const sinks = chef::sinks_of(dfa, categories);
+
+		std::array<std::optional<chef::symbol_type>, 256> byte_symbols;
+		for (auto const& [c, symbol] : *value.symbol_map) {
+			byte_symbols[static_cast<unsigned char>(c)] = symbol;
+		}
+
+		// Each state compares the upper bound of each run of bytes with the same action.
+		// The runs are in ascending order, so the lower bound is implied.
+		struct byte_run {
+			unsigned int hi;
+			byte_action action;
+		};
+		std::vector<std::vector<byte_run>> state_runs(dfa.num_states());
+		std::vector<bool> is_jump_target(dfa.num_states());
+
+		for (chef::state_type const state : dfa.states()) {
+			if (sinks[state] == chef::sink_kind::dead) continue;
+
+			auto const action = [&](unsigned int byte) -> byte_action {
+				auto const symbol = byte_symbols[byte];
+				if (!symbol) return std::nullopt;
+				chef::state_type const next = dfa.process(state, *symbol);
+				if (next == dfa.dead_state() || sinks[next] == chef::sink_kind::dead) {
+					return std::nullopt;
+				}
+				return next;
+			};
+
+			for (unsigned int lo = 0; lo < 256;) {
+				byte_action const cur = action(lo);
+				unsigned int hi = lo;
+				while (hi + 1 < 256 && action(hi + 1) == cur) {
+					++hi;
+				}
+
+				state_runs[state].push_back(byte_run{.hi = hi, .action = cur});
+				if (cur) is_jump_target[*cur] = true;
+
+				lo = hi + 1;
+			}
+		}
+
+		out << "// Generated by chef. Do not edit.\n"
+			<< "#include <string_view>\n\n"
+			<< "inline " << (is_single ? "bool " : "int ") << value.function_name
+			<< "(std::string_view str)\n"
+			<< "{\n";
+
+		if (sinks[0] == chef::sink_kind::dead) {
+			out << "\t(void)str;\n"
+				<< "\treturn " << reject << ";\n";
+			return out << "}\n";
+		}
+
+		out << "\tauto it = str.begin();\n"
+			<< "\tauto const end = str.end();\n"
+			<< "\tunsigned char c;\n";
+
+		for (chef::state_type const state : dfa.states()) {
+			if (sinks[state] == chef::sink_kind::dead) continue;
+			// Unreachable:
+			if (state != 0 && !is_jump_target[state]) continue;
+
+			if (is_jump_target[state]) {
+				out << "s" << std::uint64_t(state) << ":\n";
+			}
+			out << "\tif (it == end) return " << results[state] << ";\n"
+				<< "\tc = static_cast<unsigned char>(*it++);\n";
+
+			for (auto const& [hi, action] : state_runs[state]) {
+				out << '\t';
+				if (hi != 255) {
+					out << "if (c <= ";
+					write_byte(out, hi) << ") ";
+				}
+				if (action) {
+					out << "goto s" << std::uint64_t(*action) << ";\n";
+				} else {
+					out << "return " << reject << ";\n";
+				}
+			}
+		}
+
+		return out << "}\n";
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <chef/_/fwd.hpp>
+#include <chef/dfa/categories.hpp>
+#include <chef/dfa/dfa.hpp>
+
+namespace chef {
+	// Writes the DFA as a self-contained C++ function, with one label per state and range checks
+	// on the input byte instead of table lookups.
+	//
+	// With a single category, the function is `bool name(std::string_view)`, returning whether
+	// the whole string is accepted. With several categories (e.g. a lexer), it is
+	// `int name(std::string_view)`, returning the index of the first category accepting the
+	// whole string, or -1.
+	struct to_cpp {
+	private:
+		chef::dfa const* dfa;
+		chef::state_categories const* categories;
+		std::unordered_map<char, chef::symbol_type> const* symbol_map;
+		std::string function_name;
+
+	public:
+		explicit to_cpp(chef::dfa const& dfa,
+			chef::state_categories const& categories,
+			std::unordered_map<char, chef::symbol_type> const& symbol_map,
+			std::string function_name = "match")
+			: dfa{&dfa}
+			, categories{&categories}
+			, symbol_map{&symbol_map}
+			, function_name(CHEF_MOVE(function_name))
+		{ }
+
+		friend auto operator<<(std::ostream& out, to_cpp const& value) -> std::ostream&
+		{
+			return do_write(out, value);
+		}
+
+	private:
+		static auto do_write(std::ostream& out, to_cpp const& value) -> std::ostream&;
+	};
+}
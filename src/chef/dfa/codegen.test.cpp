@@ -0,0 +1,54 @@
+#include <chef/dfa/codegen.hpp>
+
+#include <sstream>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("dfa -> C++ writes one label per reachable state")
+{
+	// Accepts a(b)*, over the symbols {a: 0, b: 1}. State 2 is dead.
+	auto const dfa = chef::dfa(3, 2,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 0, .to = 2, .on = 1},
+			{.from = 1, .to = 2, .on = 0},
+			{.from = 1, .to = 1, .on = 1},
+			{.from = 2, .to = 2, .on = 0},
+			{.from = 2, .to = 2, .on = 1},
+		});
+	chef::state_categories const categories(3, {{1}});
+	std::unordered_map<char, chef::symbol_type> const symbol_map{{'a', 0}, {'b', 1}};
+
+	std::ostringstream out;
+	out << chef::to_cpp(dfa, categories, symbol_map, "is_abs");
+	std::string const code = out.str();
+
+	CHECK_THAT(code, Catch::Contains("inline bool is_abs(std::string_view str)"));
+	CHECK_THAT(code, Catch::Contains("s1:"));
+	CHECK_THAT(code, Catch::Contains("goto s1;"));
+	// Only state 1 is jumped to. The start needs no label, and the dead state is never entered.
+	CHECK_THAT(code, !Catch::Contains("s0:"));
+	CHECK_THAT(code, !Catch::Contains("s2"));
+	// 'b' (98) is the only byte which stays in state 1.
+	CHECK_THAT(code, Catch::Contains("if (c <= 97 /* 'a' */) return false;"));
+	CHECK_THAT(code, Catch::Contains("if (c <= 98 /* 'b' */) goto s1;"));
+}
+
+TEST_CASE("dfa -> C++ returns category indices for several categories")
+{
+	auto const dfa = chef::dfa(2, 1,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 1, .to = 1, .on = 0},
+		});
+	chef::state_categories const categories(2, {{0}, {1}});
+	std::unordered_map<char, chef::symbol_type> const symbol_map{{'x', 0}};
+
+	std::ostringstream out;
+	out << chef::to_cpp(dfa, categories, symbol_map);
+	std::string const code = out.str();
+
+	CHECK_THAT(code, Catch::Contains("inline int match(std::string_view str)"));
+	CHECK_THAT(code, Catch::Contains("if (it == end) return 0;"));
+	CHECK_THAT(code, Catch::Contains("if (it == end) return 1;"));
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <numeric>
+#include <unordered_map>
+#include <vector>
+
+#include <chef/_/ranges.hpp>
+#include <chef/dfa/dfa.hpp>
+#include <chef/dfa/fa.hpp>
+
+namespace chef {
+	// A DFA stored with row displacement ("comb vector") compression, as in yacc's tables.
+	//
+	// Each state has a default target. The transitions which differ from the default are
+	// packed into one shared `next` array, with each state's row shifted by its own `base` so
+	// that rows interleave without colliding. The `check` array records which state owns each
+	// slot:
+	//
+	//     process(from, on) = check[base[from] + on] == from ? next[base[from] + on]
+	//                                                       : default[from]
+	//
+	// For large sparse DFAs (e.g. lexers, where most transitions go to the dead state), this is
+	// much smaller than chef::dfa's dense table, while a step is still O(1).
+	class compressed_dfa {
+	private:
+		static constexpr state_type no_state = state_type(-1);
+
+		std::vector<std::size_t> base_;
+		std::vector<state_type> default_;
+		std::vector<state_type> next_;
+		std::vector<state_type> check_;
+		state_type num_states_;
+		symbol_type num_symbols_;
+
+	public:
+		// Builds the DFA from a partial edge list. Every transition missing from the list goes to
+		// `missing_to` (usually a dead state).
+		explicit compressed_dfa(state_type num_states, symbol_type num_symbols,
+			std::vector<fa_edge> const& edge_list, state_type missing_to)
+			: num_states_(num_states)
+			, num_symbols_(num_symbols)
+		{
+			// Group the edges by state; later edges for the same transition win, as in chef::dfa.
+			std::vector<std::size_t> offsets(num_states + 1);
+			for (auto const edge : edge_list) {
+				assert(edge.from < num_states);
+				assert(edge.on < num_symbols);
+				++offsets[edge.from + 1];
+			}
+			std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+			std::vector<fa_edge> by_state(edge_list.size());
+			{
+				std::vector<std::size_t> fill(offsets.begin(), offsets.end() - 1);
+				for (auto const edge : edge_list) {
+					by_state[fill[edge.from]++] = edge;
+				}
+			}
+
+			std::vector<state_type> row(num_symbols);
+			std::vector<std::vector<fa_edge>> rows(num_states);
+			for (state_type const from : std::ranges::views::iota(state_type(0), num_states)) {
+				std::fill(row.begin(), row.end(), missing_to);
+				for (std::size_t i = offsets[from]; i < offsets[from + 1]; ++i) {
+					row[by_state[i].on] = by_state[i].to;
+				}
+				rows[from] = compress_row(from, row);
+			}
+
+			pack(rows);
+		}
+
+		// Compresses the DFA. A partial DFA's dead transitions still go to dfa.dead_state(), which
+		// is num_states().
+		explicit compressed_dfa(chef::dfa const& dfa)
+			: num_states_(dfa.num_states())
+			, num_symbols_(dfa.num_symbols())
+		{
+			std::vector<state_type> row(dfa.num_symbols());
+			std::vector<std::vector<fa_edge>> rows(dfa.num_states());
+			for (state_type const from : dfa.states()) {
+				for (symbol_type const on : dfa.symbols()) {
+					row[on] = dfa.process(from, on);
+				}
+				rows[from] = compress_row(from, row);
+			}
+
+			pack(rows);
+		}
+
+	public:
+		auto num_states() const -> state_type
+		{
+			return num_states_;
+		}
+
+		auto states() const
+		{
+			return std::ranges::views::iota(state_type(0), num_states());
+		}
+
+		auto num_symbols() const -> symbol_type
+		{
+			return num_symbols_;
+		}
+
+		auto symbols() const
+		{
+			return std::ranges::views::iota(symbol_type(0), num_symbols());
+		}
+
+		auto process(state_type from, symbol_type on) const -> state_type
+		{
+			assert(from < num_states_);
+			assert(on < num_symbols_);
+
+			std::size_t const index = base_[from] + on;
+			return check_[index] == from ? next_[index] : default_[from];
+		}
+
+		// The number of slots in the shared `next`/`check` arrays.
+		auto comb_size() const -> std::size_t
+		{
+			return next_.size();
+		}
+
+	private:
+		// Picks the most common target of the row as its default, leaving only the other
+		// transitions as explicit edges.
+		auto compress_row(state_type from, std::vector<state_type> const& row)
+			-> std::vector<fa_edge>
+		{
+			std::unordered_map<state_type, std::size_t> counts;
+			state_type most_common = row.empty() ? 0 : row.front();
+			for (state_type const to : row) {
+				std::size_t const count = ++counts[to];
+				if (count > counts[most_common]) most_common = to;
+			}
+			default_.push_back(most_common);
+
+			std::vector<fa_edge> explicit_edges;
+			for (symbol_type const on : detail::indices<symbol_type>(row)) {
+				if (row[on] != most_common) {
+					explicit_edges.push_back(fa_edge{.from = from, .to = row[on], .on = on});
+				}
+			}
+			return explicit_edges;
+		}
+
+		// First-fit packing, placing the fullest rows first.
+		void pack(std::vector<std::vector<fa_edge>> const& rows)
+		{
+			std::vector<state_type> order(rows.size());
+			std::iota(order.begin(), order.end(), state_type(0));
+			std::ranges::stable_sort(order, std::ranges::greater{},
+				[&](state_type state) { return rows[state].size(); });
+
+			base_.resize(rows.size());
+			std::vector<bool> used;
+			// Every slot before this one is used.
+			std::size_t first_free = 0;
+
+			for (state_type const state : order) {
+				auto const& edges = rows[state];
+				if (edges.empty()) continue; // Any base works, as no slot will be checked as ours.
+
+				std::size_t base = first_free - std::min<std::size_t>(first_free, edges[0].on);
+				while (!std::ranges::all_of(edges, [&](fa_edge const& edge) {
+					return base + edge.on >= used.size() || !used[base + edge.on];
+				}))
+				{
+					++base;
+				}
+
+				std::size_t const end = base + edges.back().on + 1;
+				if (end > used.size()) {
+					used.resize(end);
+					next_.resize(end);
+					check_.resize(end, no_state);
+				}
+				for (auto const& edge : edges) {
+					used[base + edge.on] = true;
+					next_[base + edge.on] = edge.to;
+					check_[base + edge.on] = state;
+				}
+				base_[state] = base;
+
+				while (first_free < used.size() && used[first_free]) {
+					++first_free;
+				}
+			}
+
+			// Keep base + on in bounds for every state, without a branch in process().
+			std::size_t const max_base = base_.empty() ? 0 : *std::ranges::max_element(base_);
+			next_.resize(std::max(next_.size(), max_base + num_symbols_));
+			check_.resize(next_.size(), no_state);
+		}
+	};
+}
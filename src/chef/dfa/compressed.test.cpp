@@ -0,0 +1,55 @@
+#include <chef/dfa/compressed.hpp>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("compressed dfa matches the dense dfa")
+{
+	// Same DFA as in dfa.test.cpp
+	auto const dfa = chef::dfa(4, 2,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 0, .to = 0, .on = 1},
+			{.from = 1, .to = 0, .on = 0},
+			{.from = 1, .to = 2, .on = 1},
+			{.from = 2, .to = 0, .on = 0},
+			{.from = 2, .to = 3, .on = 1},
+			{.from = 3, .to = 1, .on = 0},
+			{.from = 3, .to = 0, .on = 1},
+		});
+
+	auto const compressed = chef::compressed_dfa(dfa);
+
+	REQUIRE(compressed.num_states() == dfa.num_states());
+	REQUIRE(compressed.num_symbols() == dfa.num_symbols());
+	for (chef::state_type const from : dfa.states()) {
+		for (chef::symbol_type const on : dfa.symbols()) {
+			CAPTURE(from, std::size_t(on));
+			CHECK(compressed.process(from, on) == dfa.process(from, on));
+		}
+	}
+}
+
+TEST_CASE("compressed dfa packs a sparse lexer-like dfa")
+{
+	// A chain over 200 symbols: state i goes to i + 1 on symbol 2 * i, and everything else
+	// goes to the dead state.
+	chef::state_type const num_states = 101;
+	chef::state_type const dead = 100;
+	std::vector<chef::fa_edge> edges;
+	for (chef::state_type from = 0; from < 100; ++from) {
+		edges.push_back({.from = from, .to = from + 1, .on = chef::symbol_type(from * 2)});
+	}
+
+	auto const compressed = chef::compressed_dfa(num_states, 200, edges, dead);
+
+	for (chef::state_type const from : compressed.states()) {
+		for (chef::symbol_type const on : compressed.symbols()) {
+			CAPTURE(from, std::size_t(on));
+			chef::state_type const expected = from < 100 && on == from * 2 ? from + 1 : dead;
+			CHECK(compressed.process(from, on) == expected);
+		}
+	}
+
+	// A dense table would have 101 * 200 slots.
+	CHECK(compressed.comb_size() < 2 * 200 + 100);
+}
@@ -1,129 +1,380 @@
 #pragma once
 
 #include <algorithm>
-#include <iterator>
-#include <set>
-#include <unordered_map>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <chef/_/fwd.hpp>
+#include <chef/_/memory.hpp>
+#include <chef/budget.hpp>
+#include <chef/dfa/categories.hpp>
 #include <chef/dfa/dfa.hpp>
 #include <chef/dfa/nfa.hpp>
+#include <chef/dfa/prune.hpp>
+#include <chef/dfa/sinks.hpp>
+#include <chef/dfa/stats.hpp>
 
 namespace chef {
 	namespace detail {
-		inline std::vector<chef::state_type> eps_closure(
-			chef::nfa const& nfa, chef::state_type const from)
-		{
-			std::set<chef::state_type> result;
+		// A set of states in [0, capacity) with O(1) insert and clear, which keeps the states in
+		// insertion order (Briggs & Torczon).
+		class sparse_set {
+		private:
+			std::vector<state_type> dense_;
+			std::vector<state_type> sparse_;
 
-			std::vector<chef::state_type> queue({from});
-			do {
-				chef::state_type const cur = queue.back();
-				queue.pop_back();
+		public:
+			explicit sparse_set(state_type capacity)
+				: sparse_(capacity)
+			{
+				dense_.reserve(capacity);
+			}
 
-				if (!result.insert(cur).second) continue;
+			bool contains(state_type state) const
+			{
+				assert(state < sparse_.size());
+				state_type const index = sparse_[state];
+				return index < dense_.size() && dense_[index] == state;
+			}
 
-				std::ranges::copy(nfa.process(cur, chef::nfa::eps), std::back_inserter(queue));
-			} while (!queue.empty());
+			// Returns whether the state was added.
+			bool insert(state_type state)
+			{
+				if (contains(state)) return false;
+				sparse_[state] = static_cast<state_type>(dense_.size());
+				dense_.push_back(state);
+				return true;
+			}
 
-			return std::vector(result.begin(), result.end());
-		}
-	}
+			void clear()
+			{
+				dense_.clear();
+			}
 
-	inline std::pair<chef::dfa, std::vector<std::unordered_set<chef::state_type>>> to_dfa(
-		chef::nfa const& nfa, std::vector<std::unordered_set<chef::state_type>> const& categories)
-	{
-		using mstate_type = std::vector<chef::state_type>;
-
-		auto const closure = [&nfa](mstate_type mstate) {
-			mstate_type result;
-			for (chef::state_type state : mstate) {
-				auto closure = detail::eps_closure(nfa, state);
-				result.insert(result.end(), closure.begin(), closure.end());
-			}
-			std::ranges::sort(result);
-			auto unique_rng = std::ranges::unique(result);
-			result.erase(unique_rng.end(), result.end());
-			return result;
+			bool empty() const
+			{
+				return dense_.empty();
+			}
+
+			// The states, in insertion order. Sorting them does not affect membership.
+			auto values() -> std::span<state_type>
+			{
+				return dense_;
+			}
+
+			auto memory_bytes() const -> std::size_t
+			{
+				return detail::heap_bytes(dense_) + detail::heap_bytes(sparse_);
+			}
 		};
 
-		chef::symbol_type const num_dfa_symbols = nfa.num_symbols() - 1;
+		// The epsilon closure of each state of the NFA, computed once.
+		class eps_closures {
+		private:
+			std::vector<std::size_t> offsets_;
+			std::vector<state_type> states_;
 
-		std::set<mstate_type> discovered_states({closure(mstate_type({0}))});
+		public:
+			explicit eps_closures(chef::nfa const& nfa)
+			{
+				offsets_.reserve(nfa.num_states() + 1);
+				offsets_.push_back(0);
+
+				sparse_set closure(nfa.num_states());
+				std::vector<state_type> stack;
+				for (state_type const from : nfa.states()) {
+					closure.clear();
+					closure.insert(from);
+					stack.assign({from});
+					while (!stack.empty()) {
+						state_type const cur = stack.back();
+						stack.pop_back();
+						for (state_type const to : nfa.process(cur, chef::nfa::eps)) {
+							if (closure.insert(to)) stack.push_back(to);
+						}
+					}
 
-		std::unordered_map<mstate_type const*, std::vector<mstate_type const*>> transition_table;
-		std::unordered_map<mstate_type const*, state_type> state_numbers;
+					states_.insert(states_.end(), closure.values().begin(), closure.values().end());
+					offsets_.push_back(states_.size());
+				}
+			}
+
+			auto operator[](state_type state) const -> std::span<state_type const>
+			{
+				return std::span<state_type const>(states_).subspan(
+					offsets_[state], offsets_[state + 1] - offsets_[state]);
+			}
 
-		// Do the conversion algorithm
+			auto memory_bytes() const -> std::size_t
+			{
+				return detail::heap_bytes(offsets_) + detail::heap_bytes(states_);
+			}
+		};
+
+		inline auto hash_states(std::span<state_type const> states) -> std::uint64_t
 		{
-			// Using a stack for the queue rather than a FIFO queue.
-			std::vector<mstate_type const*> processing_queue({&*discovered_states.begin()});
-			state_numbers.emplace(processing_queue.back(), 0);
-
-			// Outside loop to reduce allocation.
-			mstate_type next;
-			do {
-				mstate_type const* cur = processing_queue.back();
-				processing_queue.pop_back();
-
-				for (symbol_type symbol = 0; symbol < num_dfa_symbols; ++symbol) {
-					for (state_type state : *cur) {
-						auto inext = nfa.process(state, symbol + 1);
-						next.insert(next.end(), inext.begin(), inext.end());
+			std::uint64_t hash = 0xcbf29ce484222325; // FNV-1a, a state at a time
+			for (state_type const state : states) {
+				hash = (hash ^ state) * 0x100000001b3;
+			}
+			// Mix the high bits down, as the table is indexed by the low bits.
+			hash ^= hash >> 33;
+			hash *= 0xff51afd7ed558ccd;
+			hash ^= hash >> 33;
+			return hash;
+		}
+
+		// Sets `next` to the sorted epsilon closure of the states reached from `subset` on `on`.
+		inline void step(chef::nfa const& nfa, eps_closures const& closures,
+			std::span<state_type const> subset, symbol_type on, sparse_set& next)
+		{
+			next.clear();
+			for (state_type const state : subset) {
+				for (state_type const to : nfa.process(state, on)) {
+					// Closures are closed, so `to`'s closure is already in if `to` is.
+					if (next.contains(to)) continue;
+					for (state_type const reached : closures[to]) {
+						next.insert(reached);
 					}
+				}
+			}
+			std::ranges::sort(next.values());
+		}
+
+		// Interns sorted sets of NFA states, numbering them in order of discovery.
+		class subset_table {
+		private:
+			static constexpr state_type empty_slot = state_type(-1);
 
-					mstate_type actual_next;
-					std::sort(next.begin(), next.end());
-					std::unique_copy(next.begin(), next.end(), std::back_inserter(actual_next));
-					next.clear();
+			// The states of subset `i` are `states_[offsets_[i]..offsets_[i + 1])`.
+			std::vector<std::size_t> offsets_{0};
+			std::vector<state_type> states_;
+			std::vector<std::uint64_t> hashes_;
+			// Open addressing with linear probing, at most half full.
+			std::vector<state_type> slots_ = std::vector<state_type>(16, empty_slot);
 
-					actual_next = closure(actual_next);
+		public:
+			auto size() const -> std::size_t
+			{
+				return hashes_.size();
+			}
+
+			auto memory_bytes() const -> std::size_t
+			{
+				return detail::heap_bytes(offsets_) + detail::heap_bytes(states_)
+					+ detail::heap_bytes(hashes_) + detail::heap_bytes(slots_);
+			}
+
+			auto operator[](state_type subset) const -> std::span<state_type const>
+			{
+				return std::span<state_type const>(states_).subspan(
+					offsets_[subset], offsets_[subset + 1] - offsets_[subset]);
+			}
+
+			// Returns the number of the subset, and whether it was added. If `probes` is not
+			// null, the slots looked at are added to it.
+			auto intern(std::span<state_type const> subset, std::size_t* probes = nullptr)
+				-> std::pair<state_type, bool>
+			{
+				return intern(subset, detail::hash_states(subset), probes);
+			}
 
-					auto const [it, inserted] = discovered_states.emplace(CHEF_MOVE(actual_next));
-					if (inserted) {
-						processing_queue.push_back(&*it);
-						state_numbers.emplace(&*it, state_numbers.size());
+			// As above, where `hash` is detail::hash_states(subset).
+			auto intern(std::span<state_type const> subset, std::uint64_t hash,
+				std::size_t* probes = nullptr) -> std::pair<state_type, bool>
+			{
+				assert(hash == detail::hash_states(subset));
+				std::size_t slot = find_slot(hash, subset, probes);
+				if (slots_[slot] != empty_slot) return {slots_[slot], false};
+
+				auto const number = static_cast<state_type>(size());
+				states_.insert(states_.end(), subset.begin(), subset.end());
+				offsets_.push_back(states_.size());
+				hashes_.push_back(hash);
+
+				if (2 * size() > slots_.size()) {
+					rehash();
+				} else {
+					slots_[slot] = number;
+				}
+				return {number, true};
+			}
+
+		private:
+			// The slot holding the subset, or the empty slot where it would go.
+			auto find_slot(std::uint64_t hash, std::span<state_type const> subset,
+				std::size_t* probes) const -> std::size_t
+			{
+				std::size_t const mask = slots_.size() - 1;
+				for (std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+					if (probes) ++*probes;
+					state_type const number = slots_[slot];
+					if (number == empty_slot) return slot;
+					if (hashes_[number] == hash && std::ranges::equal((*this)[number], subset)) {
+						return slot;
 					}
-					transition_table[cur].push_back(&*it);
 				}
-			} while (!processing_queue.empty());
-		}
+			}
+
+			void rehash()
+			{
+				slots_.assign(std::bit_ceil(4 * size()), empty_slot);
+				std::size_t const mask = slots_.size() - 1;
+				for (state_type number = 0; number < size(); ++number) {
+					std::size_t slot = hashes_[number] & mask;
+					while (slots_[slot] != empty_slot) {
+						slot = (slot + 1) & mask;
+					}
+					slots_[slot] = number;
+				}
+			}
+		};
+	}
+
+	// As below, counting against a meter which may be shared with the rest of a larger
+	// construction.
+	inline std::pair<chef::dfa, chef::state_categories> to_dfa(chef::nfa const& nfa,
+		std::vector<std::unordered_set<chef::state_type>> const& categories, chef::dfa_kind kind,
+		chef::construction_stats* stats, detail::budget_meter& meter)
+	{
+		// States which can't be reached or can't reach a category would only make more subsets.
+		auto const [pruned_nfa, pruned_categories] = chef::prune(nfa, categories);
+
+		// Stands for the dead state until the number of states is known.
+		constexpr auto dead = chef::state_type(-1);
+
+		chef::symbol_type const num_dfa_symbols = pruned_nfa.num_symbols() - 1;
+
+		detail::eps_closures const closures = [&] {
+			detail::phase_timer const timer(stats, &chef::construction_stats::eps_closure_time);
+			return detail::eps_closures(pruned_nfa);
+		}();
+		detail::subset_table subsets;
+		// Probes are only counted when stats are asked for.
+		std::size_t* const probes = stats ? &stats->subset_probes : nullptr;
 
-		// Gather the DFA transition info into the DFA format
-		std::vector<fa_edge> edges;
-		edges.reserve(discovered_states.size() * num_dfa_symbols);
+		// Reused for every successor set.
+		detail::sparse_set next(pruned_nfa.num_states());
 
-		for (auto const& [from, transitions] : transition_table) {
-			for (symbol_type symbol = 0; symbol < num_dfa_symbols; ++symbol) {
-				edges.push_back(fa_edge{
-					.from = state_numbers.find(from)->second,
-					.to = state_numbers.find(transitions[symbol])->second,
-					.on = symbol,
-				});
+		// The DFA's transition table, one row of num_dfa_symbols per state. Subsets are numbered
+		// in the order they are found and processed in that order, so the rows are appended in
+		// order too.
+		std::vector<chef::state_type> table;
+
+		{
+			detail::phase_timer const timer(stats, &chef::construction_stats::subset_time);
+			subsets.intern(closures[0], probes);
+			for (chef::state_type cur = 0; cur < subsets.size(); ++cur) {
+				meter.check_size(
+					subsets.size(), subsets.memory_bytes() + detail::heap_bytes(table));
+				for (chef::symbol_type symbol = 0; symbol < num_dfa_symbols; ++symbol) {
+					// subsets[cur] may move as subsets are added, so it is looked up each time.
+					detail::step(pruned_nfa, closures, subsets[cur], symbol + 1, next);
+					if (kind == chef::dfa_kind::partial && next.empty()) {
+						table.push_back(dead);
+					} else {
+						table.push_back(subsets.intern(next.values(), probes).first);
+					}
+				}
 			}
 		}
 
-		// Trace categories
-		std::vector<std::unordered_set<chef::state_type>> dfa_categories;
-		dfa_categories.resize(categories.size());
-		for (std::size_t i = 0; i < categories.size(); ++i) {
-			for (mstate_type const& mstate : discovered_states) {
-				if (std::any_of(mstate.begin(), mstate.end(), [&](chef::state_type const state) {
-						return categories[i].contains(state);
-					}))
-				{
-					dfa_categories[i].insert(state_numbers.find(&mstate)->second);
-				}
+		auto const num_states = static_cast<chef::state_type>(subsets.size());
+		if (stats) {
+			stats->nfa_states = nfa.num_states();
+			stats->dfa_states = num_states;
+			stats->closures += pruned_nfa.num_states();
+			stats->note_bytes(closures.memory_bytes() + subsets.memory_bytes()
+				+ next.memory_bytes() + detail::heap_bytes(table));
+		}
+		if (kind == chef::dfa_kind::partial) std::ranges::replace(table, dead, num_states);
+
+		// A DFA state is in every category of its NFA states.
+		chef::state_categories const nfa_categories(pruned_nfa.num_states(), pruned_categories);
+		chef::state_categories dfa_categories(num_states, categories.size());
+		for (chef::state_type dfa_state = 0; dfa_state < num_states; ++dfa_state) {
+			for (chef::state_type const state : subsets[dfa_state]) {
+				dfa_categories.insert_all(dfa_state, nfa_categories.row(state));
 			}
 		}
 
-		auto const num_states = static_cast<state_type>(discovered_states.size());
+		chef::dfa dfa(num_states, num_dfa_symbols, table);
+		chef::mark_sinks(dfa, dfa_categories);
+		return std::pair{CHEF_MOVE(dfa), CHEF_MOVE(dfa_categories)};
+	}
+
+	/**
+	 * \brief Converts the NFA to an equivalent DFA with the powerset construction
+	 *
+	 * The DFA's states are numbered in breadth-first order from the initial state, 0.
+	 *
+	 * \param nfa
+	 * \param categories The NFA states of each category (e.g. final states, token types)
+	 * \param kind Whether the empty subset is a real dead state, or the partial DFA's implicit
+	 * chef::dfa::dead_state()
+	 * \param stats If not null, is filled in with the cost of each phase
+	 * \param budget Limits on the DFA's states, the memory used, and the time taken
+	 * \returns The DFA, and the DFA states of each category, with their sinks marked
+	 * \throws chef::construction_budget_error if the conversion goes over the budget
+	 */
+	inline std::pair<chef::dfa, chef::state_categories> to_dfa(
+		chef::nfa const& nfa, std::vector<std::unordered_set<chef::state_type>> const& categories,
+		chef::dfa_kind kind = chef::dfa_kind::complete, chef::construction_stats* stats = nullptr,
+		chef::budget const& budget = {})
+	{
+		detail::budget_meter meter(budget);
+		return chef::to_dfa(nfa, categories, kind, stats, meter);
+	}
+
+	// A guess at the size of an NFA's DFA, made before converting it.
+	struct dfa_size_estimate {
+		// The DFA states found: all of them if `exact`, and otherwise more than the limit.
+		std::size_t states = 0;
+		// The bytes of the transition table for that many states.
+		std::size_t table_bytes = 0;
+		bool exact = false;
+	};
+
+	/**
+	 * \brief Estimates the size of the NFA's DFA by exploring at most `limit` of its states
+	 *
+	 * This runs the start of the powerset construction without building a table, so it takes
+	 * time in `limit` rather than in the size of the DFA. A DFA which doesn't fit (`exact` is
+	 * false) is better matched lazily, such as with chef::re_derivative_engine. The NFA isn't
+	 * pruned, so subsets which chef::to_dfa() would prune away are counted too.
+	 */
+	inline auto estimate_dfa_size(chef::nfa const& nfa, std::size_t limit = 4096)
+		-> dfa_size_estimate
+	{
+		detail::eps_closures const closures(nfa);
+		detail::subset_table subsets;
+		detail::sparse_set next(nfa.num_states());
+		subsets.intern(closures[0]);
+
+		bool exact = true;
+		for (chef::state_type cur = 0; cur < subsets.size(); ++cur) {
+			if (subsets.size() > limit) {
+				exact = false;
+				break;
+			}
+			for (chef::symbol_type const on : nfa.symbols()) {
+				if (on == chef::nfa::eps) continue;
+				detail::step(nfa, closures, subsets[cur], on, next);
+				subsets.intern(next.values());
+			}
+		}
 
-		return std::pair{
-			chef::dfa(num_states, num_dfa_symbols, edges),
-			CHEF_MOVE(dfa_categories),
+		std::size_t const num_dfa_symbols = nfa.num_symbols() - 1;
+		return dfa_size_estimate{
+			.states = subsets.size(),
+			.table_bytes = subsets.size() * num_dfa_symbols * sizeof(chef::state_type),
+			.exact = exact,
 		};
 	}
 }
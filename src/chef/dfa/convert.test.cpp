@@ -1,6 +1,12 @@
 #include <chef/dfa/convert.hpp>
 
+#include <chrono>
+#include <optional>
 #include <ranges>
+#include <set>
+#include <stop_token>
+#include <string>
+#include <string_view>
 
 #include "chef/matchers.test.inl"
 
@@ -117,3 +123,117 @@ TEST_CASE("nfa -> dfa conversion works with epsilons")
 	REQUIRE(categories.size() == 1);
 	CHECK_THAT(::to_vector(categories[0]), IsPermutationOfVector({st24, st4}));
 }
+
+TEST_CASE("nfa -> dfa conversion numbers states breadth first")
+{
+	// (a|b)*a(a|b)^n: the DFA has to remember the last n + 1 symbols, so all 2^(n + 1) subsets
+	// of {1, ..., n + 1} (with 0) are reached.
+	chef::state_type const n = 9;
+	std::vector<chef::fa_edge> edges{
+		{.from = 0, .to = 0, .on = 1},
+		{.from = 0, .to = 0, .on = 2},
+		{.from = 0, .to = 1, .on = 1},
+	};
+	for (chef::state_type state = 1; state <= n; ++state) {
+		edges.push_back({.from = state, .to = state + 1, .on = 1});
+		edges.push_back({.from = state, .to = state + 1, .on = 2});
+	}
+	auto nfa = chef::nfa(n + 2, 3, edges);
+
+	auto [dfa, categories] = chef::to_dfa(nfa, {{n + 1}});
+
+	CHECK(dfa.num_states() == 1u << (n + 1));
+	// {0} -> {0, 1} (a) and {0} (b)
+	CHECK(dfa.process(0, 0) == 1);
+	CHECK(dfa.process(0, 1) == 0);
+	// {0, 1} -> {0, 1, 2} (a) and {0, 2} (b)
+	CHECK(dfa.process(1, 0) == 2);
+	CHECK(dfa.process(1, 1) == 3);
+
+	auto const run = [&dfa](std::string_view str) {
+		chef::state_type state = 0;
+		for (char const c : str) {
+			state = dfa.process(state, c == 'a' ? 0 : 1);
+		}
+		return state;
+	};
+	CHECK(categories[0].contains(run("ba" + std::string(n, 'b'))));
+	CHECK(categories[0].contains(run("a" + std::string(n, 'a'))));
+	CHECK_FALSE(categories[0].contains(run("ab" + std::string(n, 'b'))));
+}
+
+TEST_CASE("nfa -> partial dfa conversion leaves out the dead state")
+{
+	// ab
+	auto nfa = chef::nfa(3, 3,
+		{
+			{.from = 0, .to = 1, .on = 1},
+			{.from = 1, .to = 2, .on = 2},
+		});
+
+	auto const [complete, complete_categories] = chef::to_dfa(nfa, {{2}});
+	CHECK(complete.num_states() == 4);
+	CHECK_FALSE(complete.is_partial());
+
+	auto const [dfa, categories] = chef::to_dfa(nfa, {{2}}, chef::dfa_kind::partial);
+	REQUIRE(dfa.num_states() == 3);
+	CHECK(dfa.is_partial());
+	CHECK(dfa.process(0, 0) == 1);
+	CHECK(dfa.process(0, 1) == dfa.dead_state());
+	CHECK(dfa.process(1, 1) == 2);
+	CHECK(dfa.process(1, 0) == dfa.dead_state());
+	CHECK(dfa.process(2, 0) == dfa.dead_state());
+	CHECK(dfa.process(2, 1) == dfa.dead_state());
+	CHECK_THAT(::to_vector(categories[0]), IsPermutationOfVector({2}));
+}
+
+TEST_CASE("nfa -> dfa conversion ignores final states which aren't in the nfa")
+{
+	auto nfa = chef::nfa(2, 2, {{.from = 0, .to = 1, .on = 1}});
+
+	auto const [dfa, categories] = chef::to_dfa(nfa, {{1, 99}});
+
+	REQUIRE(dfa.num_states() == 3);
+	CHECK_THAT(::to_vector(categories[0]), IsPermutationOfVector({1}));
+}
+
+TEST_CASE("nfa -> dfa conversion stops at its budget")
+{
+	// (a|b)*a(a|b)^n, with 2^(n + 1) DFA states.
+	chef::state_type const n = 11;
+	std::vector<chef::fa_edge> edges{
+		{.from = 0, .to = 0, .on = 1},
+		{.from = 0, .to = 0, .on = 2},
+		{.from = 0, .to = 1, .on = 1},
+	};
+	for (chef::state_type state = 1; state <= n; ++state) {
+		edges.push_back({.from = state, .to = state + 1, .on = 1});
+		edges.push_back({.from = state, .to = state + 1, .on = 2});
+	}
+	auto const nfa = chef::nfa(n + 2, 3, edges);
+
+	auto const limit = [&](chef::budget const& budget) {
+		try {
+			chef::to_dfa(nfa, {{n + 1}}, chef::dfa_kind::complete, nullptr, budget);
+		} catch (chef::construction_budget_error const& e) {
+			return std::optional(e.limit());
+		}
+		return std::optional<chef::budget_limit>();
+	};
+	CHECK(limit({.max_states = 100}) == chef::budget_limit::states);
+	CHECK(limit({.max_bytes = 4096}) == chef::budget_limit::bytes);
+	CHECK(limit({.max_time = std::chrono::nanoseconds(0)}) == chef::budget_limit::time);
+	std::stop_source stop;
+	stop.request_stop();
+	CHECK(limit({.stop = stop.get_token()}) == chef::budget_limit::cancelled);
+	CHECK(limit({.max_states = 1u << (n + 1)}) == std::nullopt);
+
+	auto const estimate = chef::estimate_dfa_size(nfa, 1000);
+	CHECK_FALSE(estimate.exact);
+	CHECK(estimate.states > 1000);
+	auto const small = chef::estimate_dfa_size(chef::nfa(3, 3, {{.from = 0, .to = 1, .on = 1}}));
+	CHECK(small.exact);
+	// {0}, {1} and the empty subset.
+	CHECK(small.states == 3);
+	CHECK(small.table_bytes == 3 * 2 * sizeof(chef::state_type));
+}
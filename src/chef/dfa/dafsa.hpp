@@ -0,0 +1,257 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <chef/_/fwd.hpp>
+#include <chef/dfa/categories.hpp>
+#include <chef/dfa/dfa.hpp>
+#include <chef/errors.hpp>
+
+namespace chef {
+	struct dafsa_result_t {
+		chef::dfa dfa;
+		// A single category: the accepting states.
+		chef::state_categories categories;
+		// Symbols are numbered in byte order, so they sort the same way as the words.
+		std::unordered_map<char, chef::symbol_type> symbol_map;
+		// The number of words accepted from each state.
+		std::vector<std::size_t> word_counts;
+	};
+
+	// Builds the minimal acyclic DFA of a sorted word list incrementally (Daciuk, Mihov, Watson
+	// and Watson, "Incremental Construction of Minimal Acyclic Finite-State Automata").
+	//
+	// Only the path of the last word added is still open; every other state is already minimal
+	// and shared through a register, so memory stays close to the size of the final automaton
+	// and the time is linear in the total length of the words.
+	class dafsa_builder {
+	private:
+		using node_id = std::uint32_t;
+
+		struct node {
+			bool is_final = false;
+			// Sorted by byte, since the words are added in order.
+			std::vector<std::pair<unsigned char, node_id>> edges;
+			std::size_t word_count = 0;
+		};
+
+		struct node_hash {
+			std::vector<node> const* nodes;
+
+			auto operator()(node_id id) const -> std::size_t
+			{
+				node const& n = (*nodes)[id];
+				std::size_t hash = n.is_final ? 0x9e3779b97f4a7c15 : 0;
+				for (auto const& [byte, to] : n.edges) {
+					hash = (hash ^ (std::size_t(byte) << 32 | to)) * 0x100000001b3;
+				}
+				return hash;
+			}
+		};
+
+		struct node_equal {
+			std::vector<node> const* nodes;
+
+			bool operator()(node_id lhs, node_id rhs) const
+			{
+				node const& l = (*nodes)[lhs];
+				node const& r = (*nodes)[rhs];
+				return l.is_final == r.is_final && l.edges == r.edges;
+			}
+		};
+
+		static constexpr node_id root = 0;
+
+		std::vector<node> nodes_{node{}};
+		std::vector<node_id> free_nodes_;
+		// The minimal states, by their contents.
+		std::unordered_set<node_id, node_hash, node_equal> register_{
+			0, node_hash{&nodes_}, node_equal{&nodes_}};
+		// The states along the last word, from the root.
+		std::vector<node_id> open_path_{root};
+		std::string last_word_;
+		std::size_t num_words_ = 0;
+
+	public:
+		dafsa_builder() = default;
+		// The register refers to nodes_.
+		dafsa_builder(dafsa_builder const&) = delete;
+		dafsa_builder& operator=(dafsa_builder const&) = delete;
+
+		// Adds a word, which must not sort before the previous one. Adding the same word again
+		// does nothing.
+		void add(std::string_view word)
+		{
+			if (num_words_ != 0 && word <= last_word_) {
+				if (word == last_word_) return;
+				throw chef::construction_error("DAFSA words are not sorted: \"" + std::string(word)
+					+ "\" comes after \"" + last_word_ + "\"");
+			}
+
+			auto const prefix = static_cast<std::size_t>(
+				std::ranges::mismatch(word, last_word_).in1 - word.begin());
+			close_path(prefix);
+
+			for (char const c : word.substr(prefix)) {
+				node_id const next = new_node();
+				nodes_[open_path_.back()].edges.emplace_back(static_cast<unsigned char>(c), next);
+				open_path_.push_back(next);
+			}
+			nodes_[open_path_.back()].is_final = true;
+
+			last_word_ = word;
+			++num_words_;
+		}
+
+		// Builds the DFA. A dead state is added last, for the transitions the words don't use.
+		auto finish() && -> dafsa_result_t
+		{
+			close_path(0);
+			nodes_[root].word_count = word_count(nodes_[root]);
+
+			// Number the states breadth first from the root.
+			constexpr auto unnumbered = chef::state_type(-1);
+			std::vector<chef::state_type> numbers(nodes_.size(), unnumbered);
+			std::vector<node_id> order{root};
+			numbers[root] = 0;
+			std::array<bool, 256> used_bytes{};
+			for (std::size_t i = 0; i < order.size(); ++i) {
+				for (auto const& [byte, to] : nodes_[order[i]].edges) {
+					used_bytes[byte] = true;
+					if (numbers[to] == unnumbered) {
+						numbers[to] = static_cast<chef::state_type>(order.size());
+						order.push_back(to);
+					}
+				}
+			}
+
+			std::array<chef::symbol_type, 256> symbols{};
+			std::unordered_map<char, chef::symbol_type> symbol_map;
+			chef::symbol_type num_symbols = 0;
+			for (unsigned int byte = 0; byte < 256; ++byte) {
+				if (!used_bytes[byte]) continue;
+				symbols[byte] = num_symbols++;
+				symbol_map.emplace(static_cast<char>(byte), symbols[byte]);
+			}
+
+			auto const num_states = static_cast<chef::state_type>(order.size() + 1);
+			chef::state_type const dead = num_states - 1;
+			std::vector<chef::state_type> table(std::size_t(num_states) * num_symbols, dead);
+			chef::state_categories categories(num_states, 1);
+			std::vector<std::size_t> word_counts(num_states);
+			for (chef::state_type const state : std::views::iota(chef::state_type(0), dead)) {
+				node const& n = nodes_[order[state]];
+				for (auto const& [byte, to] : n.edges) {
+					table[std::size_t(state) * num_symbols + symbols[byte]] = numbers[to];
+				}
+				if (n.is_final) categories.insert(0, state);
+				word_counts[state] = n.word_count;
+			}
+
+			return dafsa_result_t{
+				.dfa = chef::dfa(num_states, num_symbols, table),
+				.categories = CHEF_MOVE(categories),
+				.symbol_map = CHEF_MOVE(symbol_map),
+				.word_counts = CHEF_MOVE(word_counts),
+			};
+		}
+
+	private:
+		auto new_node() -> node_id
+		{
+			if (free_nodes_.empty()) {
+				nodes_.emplace_back();
+				return static_cast<node_id>(nodes_.size() - 1);
+			}
+			node_id const id = free_nodes_.back();
+			free_nodes_.pop_back();
+			return id;
+		}
+
+		auto word_count(node const& n) const -> std::size_t
+		{
+			std::size_t count = n.is_final;
+			for (auto const& [byte, to] : n.edges) {
+				count += nodes_[to].word_count;
+			}
+			return count;
+		}
+
+		// Replaces the states of the open path after the first `keep` characters with their
+		// equivalents in the register, or registers them.
+		void close_path(std::size_t keep)
+		{
+			while (open_path_.size() > keep + 1) {
+				node_id const child = open_path_.back();
+				open_path_.pop_back();
+				node_id& edge_to = nodes_[open_path_.back()].edges.back().second;
+
+				nodes_[child].word_count = word_count(nodes_[child]);
+				auto const [it, inserted] = register_.insert(child);
+				if (!inserted) {
+					edge_to = *it;
+					nodes_[child] = node{};
+					free_nodes_.push_back(child);
+				}
+			}
+		}
+	};
+
+	/**
+	 * \brief Builds the minimal acyclic DFA accepting exactly the words
+	 *
+	 * \param sorted_words The words in sorted order (as std::string_view compares them)
+	 * \throws chef::construction_error if the words are not sorted
+	 */
+	template <std::ranges::input_range Words>
+		requires std::convertible_to<std::ranges::range_reference_t<Words>, std::string_view>
+	auto to_dafsa(Words const& sorted_words) -> dafsa_result_t
+	{
+		dafsa_builder builder;
+		for (std::string_view const word : sorted_words) {
+			builder.add(word);
+		}
+		return CHEF_MOVE(builder).finish();
+	}
+
+	/**
+	 * \brief Looks up the word's index in the sorted word list the DAFSA was built from
+	 *
+	 * The index can be used to find a payload for the word, as a minimal perfect hash.
+	 *
+	 * \returns The index, or std::nullopt if the word is not in the list
+	 */
+	inline auto word_index(dafsa_result_t const& dafsa, std::string_view word)
+		-> std::optional<std::size_t>
+	{
+		auto const& [dfa, categories, symbol_map, word_counts] = dafsa;
+
+		std::size_t index = 0;
+		chef::state_type state = 0;
+		for (char const c : word) {
+			auto const it = symbol_map.find(c);
+			if (it == symbol_map.end()) return std::nullopt;
+
+			// Shorter words, and words with a smaller character here, sort first.
+			if (categories[0].contains(state)) ++index;
+			for (chef::symbol_type on = 0; on < it->second; ++on) {
+				index += word_counts[dfa.process(state, on)];
+			}
+			state = dfa.process(state, it->second);
+		}
+
+		if (!categories[0].contains(state)) return std::nullopt;
+		return index;
+	}
+}
@@ -0,0 +1,86 @@
+#include <chef/dfa/dafsa.hpp>
+
+#include <random>
+#include <set>
+
+#include <chef/dfa/convert.hpp>
+#include <chef/dfa/minimize.hpp>
+#include <chef/re/to_nfa.hpp>
+
+#include <catch2/catch.hpp>
+
+namespace {
+	bool accepts(chef::dafsa_result_t const& dafsa, std::string_view word)
+	{
+		chef::state_type state = 0;
+		for (char const c : word) {
+			auto const it = dafsa.symbol_map.find(c);
+			if (it == dafsa.symbol_map.end()) return false;
+			state = dafsa.dfa.process(state, it->second);
+		}
+		return dafsa.categories[0].contains(state);
+	}
+}
+
+TEST_CASE("DAFSA accepts exactly the words")
+{
+	std::vector<std::string> const words{"", "tap", "taps", "top", "tops"};
+	auto const dafsa = chef::to_dafsa(words);
+
+	// root, t, ta/to, tap/top, taps/tops, dead
+	CHECK(dafsa.dfa.num_states() == 6);
+	for (std::string const& word : words) {
+		CHECK(accepts(dafsa, word));
+	}
+	CHECK_FALSE(accepts(dafsa, "t"));
+	CHECK_FALSE(accepts(dafsa, "tip"));
+	CHECK_FALSE(accepts(dafsa, "tapss"));
+	CHECK(dafsa.word_counts[0] == words.size());
+}
+
+TEST_CASE("DAFSA is the minimal DFA")
+{
+	std::mt19937 rng(42);
+	std::set<std::string> word_set;
+	while (word_set.size() < 300) {
+		std::string word(1 + rng() % 6, 'a');
+		for (char& c : word) {
+			c = static_cast<char>('a' + rng() % 4);
+		}
+		word_set.insert(word);
+	}
+	std::vector<std::string> const words(word_set.begin(), word_set.end());
+
+	auto const dafsa = chef::to_dafsa(words);
+
+	chef::re re;
+	for (std::string const& word : words) {
+		re = CHEF_MOVE(re) | chef::re(word);
+	}
+	auto const [nfa, nfa_accepts, symbol_map] = chef::to_nfa(re);
+	auto const [dfa, categories] = chef::to_dfa(nfa, {nfa_accepts});
+	auto const [minimal, minimal_categories] = chef::minimize(dfa, categories);
+
+	CHECK(dafsa.dfa.num_states() == minimal.num_states());
+	CHECK(dafsa.categories[0].size() == minimal_categories[0].size());
+}
+
+TEST_CASE("DAFSA finds the index of each word")
+{
+	std::vector<std::string_view> const words{"apple", "apples", "banana", "band", "bandana"};
+	auto const dafsa = chef::to_dafsa(words);
+
+	for (std::size_t i = 0; i < words.size(); ++i) {
+		CHECK(chef::word_index(dafsa, words[i]) == i);
+	}
+	CHECK(chef::word_index(dafsa, "ban") == std::nullopt);
+	CHECK(chef::word_index(dafsa, "cherry") == std::nullopt);
+}
+
+TEST_CASE("DAFSA needs sorted words")
+{
+	chef::dafsa_builder builder;
+	builder.add("b");
+	builder.add("b");
+	CHECK_THROWS_AS(builder.add("a"), chef::construction_error);
+}
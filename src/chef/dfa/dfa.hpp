@@ -1,32 +1,118 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
+#include <chef/_/fwd.hpp>
+#include <chef/_/memory.hpp>
 #include <chef/_/ranges.hpp>
 #include <chef/dfa/fa.hpp>
+#include <chef/errors.hpp>
 
 namespace chef {
+	enum class dfa_kind {
+		// Every transition goes to a real state; rejection is an explicit dead state.
+		complete,
+		// Transitions which can never lead to acceptance may go to the implicit
+		// chef::dfa::dead_state() instead.
+		partial,
+	};
+
+	// The heap bytes held by a chef::dfa, by component. The categories of its states are kept
+	// apart, in a chef::state_categories.
+	struct dfa_memory_usage {
+		std::size_t transition_table = 0;
+
+		auto total() const -> std::size_t
+		{
+			return transition_table;
+		}
+	};
+
+	// A DFA, which may be partial: transitions may go to dead_state(), which rejects everything
+	// and has no row of its own.
 	class dfa {
 	private:
-		// A 2d array.
-		std::vector<state_type> transition_table_;
+		using table_type = std::variant<std::vector<std::uint8_t>, std::vector<std::uint16_t>,
+			std::vector<std::uint32_t>>;
+
+		// A 2d array of premultiplied states (see row()), stored in the narrowest unsigned type
+		// which can hold every row, and row(dead_state()) if the DFA is partial.
+		table_type transition_table_;
 		state_type num_states_;
 		symbol_type num_symbols_;
+		// log2 of the row length: num_symbols rounded up to a power of 2.
+		std::uint8_t stride2_;
+		bool is_partial_ = false;
 
 	public:
+		// Transitions missing from the edge list go to dead_state().
 		explicit dfa(
 			state_type num_states, symbol_type num_symbols, std::vector<fa_edge> const& edge_list)
 			: num_states_(num_states)
 			, num_symbols_(num_symbols)
+			, stride2_(stride2_for(num_symbols))
 		{
-			assert(edge_list.size() == num_states * num_symbols);
-			transition_table_.resize(num_states * num_symbols);
+			assert(edge_list.size() <= std::size_t(num_states) * num_symbols);
 
+			std::vector<bool> covered(std::size_t(num_states) * num_symbols);
+			std::size_t num_covered = 0;
 			for (auto const [from, to, on] : edge_list) {
-				at(from, on) = to;
+				assert(from < num_states_);
+				assert(on < num_symbols_);
+				num_covered += !covered[std::size_t(from) * num_symbols + on];
+				covered[std::size_t(from) * num_symbols + on] = true;
 			}
+			is_partial_ = num_covered != covered.size();
+
+			allocate_table();
+			std::visit(
+				[&](auto& table) {
+					using row_type = typename std::remove_cvref_t<decltype(table)>::value_type;
+
+					for (auto const [from, to, on] : edge_list) {
+						assert(to < num_states_);
+						table[row(from) + on] = static_cast<row_type>(row(to));
+					}
+				},
+				transition_table_);
+		}
+
+		// Builds the DFA from a dense table: the target of `from` on `on` is
+		// `table[from * num_symbols + on]`, where `num_states` stands for dead_state().
+		explicit dfa(state_type num_states, symbol_type num_symbols,
+			std::vector<state_type> const& table)
+			: num_states_(num_states)
+			, num_symbols_(num_symbols)
+			, stride2_(stride2_for(num_symbols))
+			, is_partial_(std::ranges::find(table, num_states) != table.end())
+		{
+			assert(table.size() == std::size_t(num_states) * num_symbols);
+
+			allocate_table();
+			std::visit(
+				[&](auto& premultiplied) {
+					using row_type =
+						typename std::remove_cvref_t<decltype(premultiplied)>::value_type;
+
+					for (state_type from = 0; from < num_states; ++from) {
+						auto const targets = std::span(table).subspan(
+							std::size_t(from) * num_symbols, num_symbols);
+						for (symbol_type on = 0; on < num_symbols; ++on) {
+							assert(targets[on] <= num_states_);
+							premultiplied[row(from) + on] = static_cast<row_type>(row(targets[on]));
+						}
+					}
+				},
+				transition_table_);
 		}
 
 	public:
@@ -52,23 +138,90 @@ namespace chef {
 
 		auto process(state_type from, symbol_type on) const -> state_type
 		{
-			return at(from, on);
+			assert(from < num_states_);
+			assert(on < num_symbols_);
+
+			return std::visit(
+				[&](auto const& table) { return state(table[row(from) + on]); }, transition_table_);
 		}
 
-	private:
-		auto at(state_type from, symbol_type on) const -> state_type const&
+		// Whether any transition goes to dead_state().
+		bool is_partial() const
 		{
-			assert(from < num_states_);
-			assert(on < num_symbols_);
-			std::size_t const index = num_symbols_ * from + on;
-			assert(index < transition_table_.size());
+			return is_partial_;
+		}
+
+		// The implicit state of a partial DFA which rejects everything: one past the last state.
+		// It has no row in the transition table, so it must be checked for before following a
+		// transition out of it.
+		auto dead_state() const -> state_type
+		{
+			return num_states_;
+		}
+
+		// The premultiplied form of the state: the index of its row in the transition table.
+		auto row(state_type state) const -> std::size_t
+		{
+			return std::size_t(state) << stride2_;
+		}
+
+		// log2 of the length of a row of the transition table: row(state) is state << stride2().
+		auto stride2() const -> std::uint8_t
+		{
+			return stride2_;
+		}
 
-			return transition_table_[index];
+		// The state whose row starts at the index.
+		auto state(std::size_t row) const -> state_type
+		{
+			return static_cast<state_type>(row >> stride2_);
+		}
+
+		// Calls `f` with the transition table, as a std::span of premultiplied states.
+		// `table[row + on]` is the row of the state reached from the state at `row` on `on`, so
+		// a matching loop over the table takes one load per symbol.
+		template <typename F>
+		decltype(auto) visit_table(F&& f) const
+		{
+			return std::visit(
+				[&](auto const& table) -> decltype(auto) { return CHEF_FWD(f)(std::span(table)); },
+				transition_table_);
+		}
+
+		auto memory_usage() const -> chef::dfa_memory_usage
+		{
+			return chef::dfa_memory_usage{
+				.transition_table = std::visit(
+					[](auto const& table) { return detail::heap_bytes(table); }, transition_table_),
+			};
+		}
+
+	private:
+		// Sizes the transition table, in the narrowest type which can hold every row.
+		void allocate_table()
+		{
+			std::uint64_t const table_size = std::uint64_t(num_states_) << stride2_;
+			// row(dead_state()) is table_size, so a partial DFA needs one more value.
+			std::uint64_t const num_rows = table_size + is_partial_;
+			// Every slot starts out going to the dead state.
+			auto const dead_row = static_cast<std::uint32_t>(table_size);
+			if (num_rows <= std::numeric_limits<std::uint8_t>::max() + 1ull) {
+				transition_table_.emplace<std::vector<std::uint8_t>>(
+					table_size, static_cast<std::uint8_t>(dead_row));
+			} else if (num_rows <= std::numeric_limits<std::uint16_t>::max() + 1ull) {
+				transition_table_.emplace<std::vector<std::uint16_t>>(
+					table_size, static_cast<std::uint16_t>(dead_row));
+			} else if (num_rows <= std::numeric_limits<std::uint32_t>::max() + 1ull) {
+				transition_table_.emplace<std::vector<std::uint32_t>>(table_size, dead_row);
+			} else {
+				throw chef::construction_error("DFA is too large to index its transition table");
+			}
 		}
 
-		auto at(state_type from, symbol_type on) -> state_type&
+		static auto stride2_for(symbol_type num_symbols) -> std::uint8_t
 		{
-			return const_cast<state_type&>(std::as_const(*this).at(from, on));
+			if (num_symbols <= 1) return 0;
+			return static_cast<std::uint8_t>(std::bit_width(unsigned(num_symbols) - 1));
 		}
 	};
 }
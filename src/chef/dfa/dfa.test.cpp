@@ -1,5 +1,7 @@
 #include <chef/dfa/dfa.hpp>
 
+#include <tl/tl.hpp>
+
 #include <catch2/catch.hpp>
 
 TEST_CASE("dfa works")
@@ -26,3 +28,81 @@ TEST_CASE("dfa works")
 	CHECK(dfa.process(3, 0) == 1);
 	CHECK(dfa.process(3, 1) == 0);
 }
+
+TEST_CASE("dfa stores premultiplied states in the narrowest type")
+{
+	auto const make_cycle = [](chef::state_type num_states, chef::symbol_type num_symbols) {
+		std::vector<chef::fa_edge> edges;
+		for (chef::state_type from = 0; from < num_states; ++from) {
+			for (chef::symbol_type on = 0; on < num_symbols; ++on) {
+				edges.push_back({.from = from, .to = (from + on) % num_states, .on = on});
+			}
+		}
+		return chef::dfa(num_states, num_symbols, edges);
+	};
+	auto const row_size
+		= [](chef::dfa const& dfa) { return dfa.visit_table([] TL(sizeof(_1[0]))); };
+
+	// 3 symbols: rows are 4 apart.
+	auto const small = make_cycle(64, 3);
+	CHECK(row_size(small) == 1);
+	CHECK(small.stride2() == 2);
+	CHECK(small.row(5) == 20);
+	CHECK(small.state(20) == 5);
+	CHECK(small.process(63, 2) == 1);
+	small.visit_table([&](auto const table) {
+		CHECK(table[small.row(63) + 2] == small.row(1));
+	});
+
+	auto const medium = make_cycle(65, 3);
+	CHECK(row_size(medium) == 2);
+	CHECK(medium.process(64, 2) == 1);
+
+	auto const large = make_cycle(20000, 4);
+	CHECK(row_size(large) == 4);
+	CHECK(large.process(19999, 3) == 2);
+}
+
+TEST_CASE("partial dfa sends missing transitions to the dead state")
+{
+	auto const dfa = chef::dfa(2, 2,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 1, .to = 1, .on = 1},
+		});
+
+	CHECK(dfa.is_partial());
+	CHECK(dfa.dead_state() == 2);
+	CHECK(dfa.process(0, 0) == 1);
+	CHECK(dfa.process(0, 1) == dfa.dead_state());
+	CHECK(dfa.process(1, 0) == dfa.dead_state());
+	CHECK(dfa.process(1, 1) == 1);
+	dfa.visit_table([&](auto const table) { CHECK(dfa.row(dfa.dead_state()) == table.size()); });
+
+	CHECK_FALSE(chef::dfa(1, 1, {{.from = 0, .to = 0, .on = 0}}).is_partial());
+	CHECK(chef::dfa(2, 1, std::vector<chef::state_type>{1, 2}).is_partial());
+
+	// 128 states of 2 symbols fill a byte table, so the dead state's row needs a wider one.
+	std::vector<chef::fa_edge> edges;
+	for (chef::state_type from = 0; from < 128; ++from) {
+		edges.push_back({.from = from, .to = (from + 1) % 128, .on = 0});
+	}
+	auto const wide = chef::dfa(128, 2, edges);
+	CHECK(wide.visit_table([] TL(sizeof(_1[0]))) == 2);
+	CHECK(wide.process(127, 0) == 0);
+	CHECK(wide.process(127, 1) == wide.dead_state());
+}
+
+TEST_CASE("dfa reports its memory usage")
+{
+	// 300 states need 16-bit rows.
+	std::vector<chef::fa_edge> edges;
+	for (chef::state_type state = 0; state < 300; ++state) {
+		edges.push_back({.from = state, .to = chef::state_type((state + 1) % 300), .on = 0});
+		edges.push_back({.from = state, .to = 0, .on = 1});
+	}
+	auto const dfa = chef::dfa(300, 2, edges);
+
+	CHECK(dfa.memory_usage().transition_table == 300 * 2 * sizeof(std::uint16_t));
+	CHECK(dfa.memory_usage().total() == dfa.memory_usage().transition_table);
+}
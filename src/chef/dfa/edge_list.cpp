@@ -0,0 +1,192 @@
+#include "./edge_list.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <limits>
+
+#include <chef/_/fwd.hpp>
+#include <chef/errors.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chef {
+	namespace {
+		// Smaller chunks aren't worth a thread of their own.
+		constexpr std::size_t min_chunk_size = std::size_t(1) << 20;
+
+		struct parsed_chunk {
+			std::vector<chef::fa_edge> edges;
+			// One more than the largest state and symbol in the chunk.
+			std::uint64_t num_states = 0;
+			unsigned num_symbols = 0;
+			// Why the chunk failed to parse, and where, if it did.
+			char const* error = nullptr;
+			std::size_t error_offset = 0;
+		};
+
+		bool is_blank(char c)
+		{
+			return c == ' ' || c == '\t' || c == '\r';
+		}
+
+		// Parses the whole lines in text[first, last).
+		void parse_chunk(
+			std::string_view text, std::size_t first, std::size_t last, parsed_chunk& out)
+		{
+			char const* cur = text.data() + first;
+			char const* const end = text.data() + last;
+			// Each edge takes at least 6 characters.
+			out.edges.reserve((last - first) / 6);
+
+			auto const fail = [&](char const* why) {
+				out.error = why;
+				out.error_offset = static_cast<std::size_t>(cur - text.data());
+			};
+			auto const skip_blanks = [&] {
+				while (cur != end && is_blank(*cur)) ++cur;
+			};
+			auto const parse_number = [&](auto& value) {
+				skip_blanks();
+				auto const [next, ec] = std::from_chars(cur, end, value);
+				if (ec == std::errc::result_out_of_range) {
+					fail("Number too large");
+					return false;
+				}
+				if (ec != std::errc()) {
+					fail("Expected a number");
+					return false;
+				}
+				cur = next;
+				return true;
+			};
+
+			while (cur != end) {
+				skip_blanks();
+				if (cur == end) break;
+				if (*cur == '\n') {
+					++cur;
+					continue;
+				}
+
+				chef::state_type from;
+				chef::state_type to;
+				unsigned symbol;
+				if (!parse_number(from) || !parse_number(to) || !parse_number(symbol)) return;
+				skip_blanks();
+				if (cur != end && *cur != '\n') return fail("Expected the end of the line");
+				// The number of states and symbols must fit in their types too.
+				if (std::max(from, to) == std::numeric_limits<chef::state_type>::max()) {
+					return fail("State too large");
+				}
+				if (symbol >= std::numeric_limits<chef::symbol_type>::max()) {
+					return fail("Symbol too large");
+				}
+
+				out.edges.push_back(
+					{.from = from, .to = to, .on = static_cast<chef::symbol_type>(symbol)});
+				out.num_states = std::max<std::uint64_t>(out.num_states, std::max(from, to) + 1);
+				out.num_symbols = std::max(out.num_symbols, symbol + 1);
+			}
+		}
+
+		// Closes the mapping of a file.
+		struct mapping {
+			void* data;
+			std::size_t size;
+
+			explicit mapping(void* data, std::size_t size)
+				: data(data)
+				, size(size)
+			{ }
+
+			mapping(mapping const&) = delete;
+			auto operator=(mapping const&) -> mapping& = delete;
+
+			~mapping()
+			{
+				::munmap(data, size);
+			}
+		};
+	}
+
+	auto parse_edge_list(std::string_view text, std::size_t num_threads) -> chef::edge_list
+	{
+		num_threads = std::clamp<std::size_t>(text.size() / min_chunk_size, 1, num_threads);
+
+		// Each chunk ends just after a newline, so lines aren't split.
+		std::vector<std::size_t> bounds{0};
+		for (std::size_t chunk = 1; chunk < num_threads; ++chunk) {
+			std::size_t bound = std::max(bounds.back(), text.size() * chunk / num_threads);
+			bound = std::min(text.find('\n', bound), text.size());
+			bounds.push_back(bound == text.size() ? bound : bound + 1);
+		}
+		bounds.push_back(text.size());
+
+		std::vector<parsed_chunk> chunks(num_threads);
+		{
+			std::vector<std::jthread> threads;
+			threads.reserve(num_threads - 1);
+			for (std::size_t chunk = 1; chunk < num_threads; ++chunk) {
+				threads.emplace_back([&, chunk] {
+					parse_chunk(text, bounds[chunk], bounds[chunk + 1], chunks[chunk]);
+				});
+			}
+			parse_chunk(text, bounds[0], bounds[1], chunks[0]);
+		}
+
+		chef::edge_list result;
+		std::size_t num_edges = 0;
+		std::uint64_t num_states = result.num_states;
+		for (parsed_chunk const& chunk : chunks) {
+			if (chunk.error) {
+				auto const line = std::count(text.begin(), text.begin() + chunk.error_offset, '\n');
+				throw chef::construction_error(std::string(chunk.error) + " on line "
+					+ std::to_string(line + 1) + " of the edge list");
+			}
+			num_edges += chunk.edges.size();
+			num_states = std::max(num_states, chunk.num_states);
+			result.num_symbols = std::max(
+				result.num_symbols, static_cast<chef::symbol_type>(chunk.num_symbols));
+		}
+		result.num_states = static_cast<chef::state_type>(num_states);
+
+		if (chunks.size() == 1) {
+			result.edges = CHEF_MOVE(chunks[0].edges);
+		} else {
+			result.edges.reserve(num_edges);
+			for (parsed_chunk const& chunk : chunks) {
+				result.edges.insert(result.edges.end(), chunk.edges.begin(), chunk.edges.end());
+			}
+		}
+		return result;
+	}
+
+	auto load_edge_list(std::string const& path, std::size_t num_threads) -> chef::edge_list
+	{
+		int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) throw chef::construction_error("Cannot open edge list: " + path);
+
+		struct ::stat st;
+		if (::fstat(fd, &st) != 0) {
+			::close(fd);
+			throw chef::construction_error("Cannot read edge list: " + path);
+		}
+		auto const file_size = static_cast<std::size_t>(st.st_size);
+		if (file_size == 0) {
+			::close(fd);
+			return chef::edge_list{};
+		}
+
+		void* const data = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (data == MAP_FAILED) throw chef::construction_error("Cannot map edge list: " + path);
+		mapping const file(data, file_size);
+
+		return chef::parse_edge_list(
+			std::string_view(static_cast<char const*>(file.data), file.size), num_threads);
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <chef/dfa/fa.hpp>
+#include <chef/dfa/nfa.hpp>
+
+// A text format for automata: one `from to symbol` line per edge, with the numbers separated by
+// spaces or tabs. Blank lines are skipped. States and symbols are numbered densely from 0, so
+// the automaton has one more state than the largest state number, and likewise for symbols.
+// As for chef::nfa, symbol 0 is epsilon. There is always at least the start state 0 and
+// epsilon, even if the list has no edges.
+
+namespace chef {
+	struct edge_list {
+		std::vector<chef::fa_edge> edges;
+		chef::state_type num_states = 1;
+		chef::symbol_type num_symbols = 1;
+
+		auto to_nfa() const -> chef::nfa
+		{
+			return chef::nfa(num_states, num_symbols, edges);
+		}
+	};
+
+	/**
+	 * \brief Parses an edge list
+	 *
+	 * Large inputs are split into chunks of whole lines, which are parsed in parallel. The edges
+	 * stay in the order of the text.
+	 *
+	 * Throws chef::construction_error if a line is not an edge, or a number is too large.
+	 *
+	 * \param text
+	 * \param num_threads The most threads to use, including the calling thread
+	 * \returns The edges, and the number of states and symbols they use
+	 */
+	auto parse_edge_list(std::string_view text,
+		std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency()))
+		-> chef::edge_list;
+
+	/**
+	 * \brief Maps the file and parses it as an edge list
+	 *
+	 * Throws chef::construction_error if the file can't be read, or as chef::parse_edge_list().
+	 *
+	 * \param path
+	 * \param num_threads The most threads to use, including the calling thread
+	 * \returns The edges, and the number of states and symbols they use
+	 */
+	auto load_edge_list(std::string const& path,
+		std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency()))
+		-> chef::edge_list;
+}
@@ -0,0 +1,119 @@
+#include <chef/dfa/edge_list.hpp>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <chef/dfa/convert.hpp>
+#include <chef/errors.hpp>
+
+#include <catch2/catch.hpp>
+
+namespace {
+	bool same_edges(std::vector<chef::fa_edge> const& lhs, std::vector<chef::fa_edge> const& rhs)
+	{
+		return std::ranges::equal(lhs, rhs, [](chef::fa_edge const a, chef::fa_edge const b) {
+			return a.from == b.from && a.to == b.to && a.on == b.on;
+		});
+	}
+}
+
+TEST_CASE("edge lists are parsed")
+{
+	auto const list = chef::parse_edge_list("0 1 2\n\n1\t7 0\r\n  7 0 1  \n3 3 1");
+
+	CHECK(same_edges(list.edges,
+		{
+			{.from = 0, .to = 1, .on = 2},
+			{.from = 1, .to = 7, .on = 0},
+			{.from = 7, .to = 0, .on = 1},
+			{.from = 3, .to = 3, .on = 1},
+		}));
+	// States need not be used to be counted.
+	CHECK(list.num_states == 8);
+	CHECK(list.num_symbols == 3);
+
+	auto const nfa = list.to_nfa();
+	CHECK(nfa.process(1, chef::nfa::eps).size() == 1);
+	CHECK(nfa.process(4, 1).empty());
+
+}
+
+TEST_CASE("empty edge lists have the start state and epsilon")
+{
+	for (std::string_view const text : {"", "\n \n"}) {
+		auto const list = chef::parse_edge_list(text);
+		CHECK(list.edges.empty());
+		CHECK(list.num_states == 1);
+		CHECK(list.num_symbols == 1);
+
+		auto const [dfa, categories] = chef::to_dfa(list.to_nfa(), {{0}});
+		CHECK(dfa.num_states() == 1);
+		CHECK(dfa.num_symbols() == 0);
+		CHECK(categories[0].contains(0));
+	}
+}
+
+TEST_CASE("edge list errors name the line")
+{
+	CHECK_THROWS_WITH(
+		chef::parse_edge_list("0 1 2\n0 1\n"), "Expected a number on line 2 of the edge list");
+	CHECK_THROWS_WITH(chef::parse_edge_list("0 1 2 3\n"),
+		"Expected the end of the line on line 1 of the edge list");
+	CHECK_THROWS_WITH(chef::parse_edge_list("\n\n0 1 -2\n"),
+		"Expected a number on line 3 of the edge list");
+	CHECK_THROWS_WITH(chef::parse_edge_list("0 99999999999 2\n"),
+		"Number too large on line 1 of the edge list");
+	CHECK_THROWS_WITH(
+		chef::parse_edge_list("0 1 255\n"), "Symbol too large on line 1 of the edge list");
+	CHECK_THROWS_WITH(
+		chef::parse_edge_list("4294967295 0 0\n"), "State too large on line 1 of the edge list");
+}
+
+TEST_CASE("edge lists are parsed in parallel in order")
+{
+	// Large enough to be split into chunks.
+	std::string text;
+	std::vector<chef::fa_edge> expected;
+	for (chef::state_type state = 0; text.size() < (std::size_t(1) << 22); ++state) {
+		auto const on = static_cast<chef::symbol_type>(state % 7);
+		text += std::to_string(state) + ' ' + std::to_string(state / 2) + ' '
+			+ std::to_string(on) + '\n';
+		expected.push_back({.from = state, .to = state / 2, .on = on});
+	}
+
+	auto const list = chef::parse_edge_list(text, 4);
+	CHECK(same_edges(list.edges, expected));
+	CHECK(list.num_states == expected.size());
+	CHECK(list.num_symbols == 7);
+
+	text += "0 0\n";
+	CHECK_THROWS_WITH(chef::parse_edge_list(text, 4),
+		"Expected a number on line " + std::to_string(expected.size() + 1)
+			+ " of the edge list");
+}
+
+TEST_CASE("edge lists are loaded from files")
+{
+	// A random suffix keeps concurrent test runs from sharing the file.
+	auto const name = "chef-edge-list.test." + std::to_string(std::random_device()());
+	auto const path = (std::filesystem::temp_directory_path() / name).string();
+	{
+		std::ofstream out(path);
+		out << "0 1 1\n1 2 0\n";
+	}
+
+	auto const list = chef::load_edge_list(path);
+	std::error_code ignored;
+	std::filesystem::remove(path, ignored);
+
+	CHECK(list.edges.size() == 2);
+	CHECK(list.num_states == 3);
+	CHECK(list.num_symbols == 2);
+
+	CHECK_THROWS_AS(chef::load_edge_list(path), chef::construction_error);
+}
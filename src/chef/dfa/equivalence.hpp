@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <chef/_/fwd.hpp>
+#include <chef/dfa/categories.hpp>
+#include <chef/dfa/dfa.hpp>
+#include <chef/dfa/minimize.hpp>
+
+namespace chef {
+	// The answer to a question about the languages of DFAs.
+	struct language_comparison {
+		bool holds;
+		// If the answer is no, a string of symbols which shows it.
+		std::vector<chef::symbol_type> counterexample;
+
+		explicit operator bool() const
+		{
+			return holds;
+		}
+	};
+
+	namespace detail {
+		// A disjoint-set forest with path halving and union by size.
+		class union_find {
+		private:
+			std::vector<std::size_t> parent_;
+			std::vector<std::size_t> size_;
+
+		public:
+			explicit union_find(std::size_t size)
+				: parent_(size)
+				, size_(size, 1)
+			{
+				std::iota(parent_.begin(), parent_.end(), std::size_t(0));
+			}
+
+			auto find(std::size_t element) -> std::size_t
+			{
+				while (parent_[element] != element) {
+					parent_[element] = parent_[parent_[element]];
+					element = parent_[element];
+				}
+				return element;
+			}
+
+			// Returns whether the sets were separate.
+			bool unite(std::size_t lhs, std::size_t rhs)
+			{
+				lhs = find(lhs);
+				rhs = find(rhs);
+				if (lhs == rhs) return false;
+				if (size_[lhs] < size_[rhs]) std::swap(lhs, rhs);
+				parent_[rhs] = lhs;
+				size_[lhs] += size_[rhs];
+				return true;
+			}
+		};
+
+		// A pair of states of two DFAs, found by following `on` from the pair `parent`.
+		struct pair_record {
+			chef::state_type lhs;
+			chef::state_type rhs;
+			std::size_t parent;
+			chef::symbol_type on;
+		};
+
+		// The symbols leading from the first record to `record`.
+		inline auto path_to(std::vector<pair_record> const& records, std::size_t record)
+			-> std::vector<chef::symbol_type>
+		{
+			std::vector<chef::symbol_type> path;
+			for (; record != 0; record = records[record].parent) {
+				path.push_back(records[record].on);
+			}
+			return std::vector<chef::symbol_type>(path.rbegin(), path.rend());
+		}
+	}
+
+	/**
+	 * \brief Checks whether the DFAs accept the same strings, without minimizing them
+	 *
+	 * Uses Hopcroft and Karp's algorithm: pairs of states which must be equivalent are merged
+	 * in a union-find structure, breadth first from the start states, so it runs in nearly
+	 * linear time in the size of the DFAs. The DFAs must number their symbols the same way,
+	 * and may be partial.
+	 *
+	 * \returns Whether the languages are equal, or else a string which one DFA accepts and the
+	 * other doesn't
+	 */
+	inline auto equivalent(chef::dfa const& lhs,
+		chef::category_view lhs_accepts, chef::dfa const& rhs,
+		chef::category_view rhs_accepts) -> chef::language_comparison
+	{
+		assert(lhs.num_symbols() == rhs.num_symbols());
+
+		// The states of lhs, then of rhs, including their dead states.
+		std::size_t const rhs_offset = detail::num_states_with_dead(lhs);
+		detail::union_find classes(rhs_offset + detail::num_states_with_dead(rhs));
+
+		classes.unite(0, rhs_offset);
+		std::vector<detail::pair_record> records{{.lhs = 0, .rhs = 0, .parent = 0, .on = 0}};
+		for (std::size_t cur = 0; cur < records.size(); ++cur) {
+			auto const [lhs_state, rhs_state, parent, on] = records[cur];
+			if (lhs_accepts.contains(lhs_state) != rhs_accepts.contains(rhs_state)) {
+				return {.holds = false, .counterexample = detail::path_to(records, cur)};
+			}
+
+			for (chef::symbol_type const next_on : lhs.symbols()) {
+				chef::state_type const lhs_next = detail::successor(lhs, lhs_state, next_on);
+				chef::state_type const rhs_next = detail::successor(rhs, rhs_state, next_on);
+				if (classes.unite(lhs_next, rhs_offset + rhs_next)) {
+					records.push_back(
+						{.lhs = lhs_next, .rhs = rhs_next, .parent = cur, .on = next_on});
+				}
+			}
+		}
+		return {.holds = true, .counterexample = {}};
+	}
+
+	/**
+	 * \brief Checks whether every string `rhs` accepts is accepted by `lhs`
+	 *
+	 * Searches the product of the DFAs breadth first as it is built, stopping at the first pair
+	 * of states where `rhs` accepts and `lhs` doesn't. Pairs where `rhs` is in its dead state are
+	 * not followed. The DFAs must number their symbols the same way, and may be partial.
+	 *
+	 * \returns Whether the language of `lhs` includes that of `rhs`, or else a shortest string
+	 * which `rhs` accepts and `lhs` doesn't
+	 */
+	inline auto includes(chef::dfa const& lhs,
+		chef::category_view lhs_accepts, chef::dfa const& rhs,
+		chef::category_view rhs_accepts) -> chef::language_comparison
+	{
+		assert(lhs.num_symbols() == rhs.num_symbols());
+
+		auto const key = [](chef::state_type lhs_state, chef::state_type rhs_state) {
+			return std::uint64_t(lhs_state) << 32 | rhs_state;
+		};
+
+		std::unordered_set<std::uint64_t> seen{key(0, 0)};
+		std::vector<detail::pair_record> records{{.lhs = 0, .rhs = 0, .parent = 0, .on = 0}};
+		for (std::size_t cur = 0; cur < records.size(); ++cur) {
+			auto const [lhs_state, rhs_state, parent, on] = records[cur];
+			if (rhs_accepts.contains(rhs_state) && !lhs_accepts.contains(lhs_state)) {
+				return {.holds = false, .counterexample = detail::path_to(records, cur)};
+			}
+
+			for (chef::symbol_type const next_on : lhs.symbols()) {
+				chef::state_type const rhs_next = detail::successor(rhs, rhs_state, next_on);
+				if (rhs_next == rhs.dead_state()) continue;
+				chef::state_type const lhs_next = detail::successor(lhs, lhs_state, next_on);
+				if (seen.insert(key(lhs_next, rhs_next)).second) {
+					records.push_back(
+						{.lhs = lhs_next, .rhs = rhs_next, .parent = cur, .on = next_on});
+				}
+			}
+		}
+		return {.holds = true, .counterexample = {}};
+	}
+}
@@ -0,0 +1,143 @@
+#include <chef/dfa/equivalence.hpp>
+
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace {
+	// A single category: the accepting states.
+	auto final_states(chef::dfa const& dfa, std::unordered_set<chef::state_type> const& states)
+		-> chef::state_categories
+	{
+		return chef::state_categories(dfa.num_states(), {states});
+	}
+
+	bool accepts(chef::dfa const& dfa, chef::category_view accepts,
+		std::vector<chef::symbol_type> const& str)
+	{
+		chef::state_type state = 0;
+		for (chef::symbol_type const on : str) {
+			state = dfa.process(state, on);
+			if (state == dfa.dead_state()) return false;
+		}
+		return accepts.contains(state);
+	}
+}
+
+TEST_CASE("dfa equivalence")
+{
+	// An even number of a's (symbol 0), in 2 states and in 4.
+	auto const even_a = chef::dfa(2, 2,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 0, .to = 0, .on = 1},
+			{.from = 1, .to = 0, .on = 0},
+			{.from = 1, .to = 1, .on = 1},
+		});
+	auto const even_a_4 = chef::dfa(4, 2,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 0, .to = 2, .on = 1},
+			{.from = 1, .to = 2, .on = 0},
+			{.from = 1, .to = 3, .on = 1},
+			{.from = 2, .to = 3, .on = 0},
+			{.from = 2, .to = 0, .on = 1},
+			{.from = 3, .to = 0, .on = 0},
+			{.from = 3, .to = 1, .on = 1},
+		});
+
+	auto const even_a_final = final_states(even_a, {0});
+	auto const even_a_4_final = final_states(even_a_4, {0, 2});
+	CHECK(chef::equivalent(even_a, even_a_final[0], even_a_4, even_a_4_final[0]));
+	CHECK(chef::equivalent(even_a_4, even_a_4_final[0], even_a, even_a_final[0]));
+
+	// Multiples of 4 a's
+	auto const four_a_final = final_states(even_a_4, {0});
+	auto const result = chef::equivalent(even_a, even_a_final[0], even_a_4, four_a_final[0]);
+	REQUIRE_FALSE(result);
+	CHECK(accepts(even_a, even_a_final[0], result.counterexample)
+		!= accepts(even_a_4, four_a_final[0], result.counterexample));
+
+	// A partial DFA accepting only "b" against a complete one with an explicit dead state.
+	auto const just_b = chef::dfa(2, 2, {{.from = 0, .to = 1, .on = 1}});
+	auto const just_b_complete = chef::dfa(3, 2,
+		{
+			{.from = 0, .to = 2, .on = 0},
+			{.from = 0, .to = 1, .on = 1},
+			{.from = 1, .to = 2, .on = 0},
+			{.from = 1, .to = 2, .on = 1},
+			{.from = 2, .to = 2, .on = 0},
+			{.from = 2, .to = 2, .on = 1},
+		});
+	auto const just_b_final = final_states(just_b, {1});
+	auto const just_b_complete_final = final_states(just_b_complete, {1});
+	auto const not_empty_final = final_states(just_b_complete, {1, 2});
+	CHECK(chef::equivalent(just_b, just_b_final[0], just_b_complete, just_b_complete_final[0]));
+	auto const not_empty
+		= chef::equivalent(just_b, just_b_final[0], just_b_complete, not_empty_final[0]);
+	REQUIRE_FALSE(not_empty);
+	CHECK_FALSE(accepts(just_b, just_b_final[0], not_empty.counterexample));
+	CHECK(accepts(just_b_complete, not_empty_final[0], not_empty.counterexample));
+}
+
+TEST_CASE("dfa equivalence agrees with minimization")
+{
+	std::mt19937 rng(GENERATE(1u, 2u, 3u, 4u));
+	chef::state_type const num_states = 60;
+	chef::symbol_type const num_symbols = 2;
+
+	std::vector<chef::fa_edge> edges;
+	for (chef::state_type from = 0; from < num_states; ++from) {
+		for (chef::symbol_type on = 0; on < num_symbols; ++on) {
+			edges.push_back({.from = from, .to = chef::state_type(rng() % num_states), .on = on});
+		}
+	}
+	auto const dfa = chef::dfa(num_states, num_symbols, edges);
+	chef::state_categories categories(num_states, 1);
+	for (chef::state_type state = 0; state < num_states; ++state) {
+		if (rng() % 3 == 0) categories.insert(0, state);
+	}
+	auto const [minimal, minimal_categories] = chef::minimize(dfa, categories);
+
+	CHECK(chef::equivalent(dfa, categories[0], minimal, minimal_categories[0]));
+
+	// Flipping one reachable state's acceptance changes the language.
+	chef::state_categories changed(minimal.num_states(), 1);
+	chef::state_type const flipped = rng() % minimal.num_states();
+	for (chef::state_type const state : minimal.states()) {
+		if (minimal_categories.contains(0, state) != (state == flipped)) changed.insert(0, state);
+	}
+	auto const result = chef::equivalent(dfa, categories[0], minimal, changed[0]);
+	REQUIRE_FALSE(result);
+	CHECK(::accepts(dfa, categories[0], result.counterexample)
+		!= ::accepts(minimal, changed[0], result.counterexample));
+}
+
+TEST_CASE("dfa inclusion")
+{
+	// a*b (symbols a = 0, b = 1), partial.
+	auto const a_star_b = chef::dfa(2, 2,
+		{
+			{.from = 0, .to = 0, .on = 0},
+			{.from = 0, .to = 1, .on = 1},
+		});
+	// Strings ending in b.
+	auto const ends_b = chef::dfa(2, 2,
+		{
+			{.from = 0, .to = 0, .on = 0},
+			{.from = 0, .to = 1, .on = 1},
+			{.from = 1, .to = 0, .on = 0},
+			{.from = 1, .to = 1, .on = 1},
+		});
+
+	auto const a_star_b_final = final_states(a_star_b, {1});
+	auto const ends_b_final = final_states(ends_b, {1});
+	CHECK(chef::includes(ends_b, ends_b_final[0], a_star_b, a_star_b_final[0]));
+
+	auto const result = chef::includes(a_star_b, a_star_b_final[0], ends_b, ends_b_final[0]);
+	REQUIRE_FALSE(result);
+	// The shortest string ending in b which isn't a*b.
+	CHECK(result.counterexample == std::vector<chef::symbol_type>{1, 1});
+}
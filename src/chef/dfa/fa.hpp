@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
+#include <unordered_map>
+
+#include <chef/_/memory.hpp>
 
 namespace chef {
 	using state_type = std::uint32_t;
@@ -11,4 +15,11 @@ namespace chef {
 		state_type to;
 		symbol_type on;
 	};
+
+	// The heap bytes held by a map from characters to symbols.
+	inline auto memory_usage(std::unordered_map<char, symbol_type> const& symbol_map)
+		-> std::size_t
+	{
+		return detail::heap_bytes(symbol_map);
+	}
 }
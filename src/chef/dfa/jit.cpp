@@ -0,0 +1,282 @@
+#include "./jit.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <optional>
+#include <utility>
+
+#include <chef/dfa/sinks.hpp>
+
+#if defined(__x86_64__) && defined(__linux__)
+#	define CHEF_JIT_X86_64 1
+#	include <sys/mman.h>
+#else
+#	define CHEF_JIT_X86_64 0
+#endif
+
+namespace {
+	// What each state does on each input byte: go to another state, or reject.
+	class byte_transitions {
+	private:
+		std::array<std::optional<chef::symbol_type>, 256> byte_symbols_;
+		std::vector<chef::sink_kind> sinks_;
+		chef::dfa const* dfa_;
+
+	public:
+		explicit byte_transitions(chef::dfa const& dfa,
+			chef::category_view accepts,
+			std::unordered_map<char, chef::symbol_type> const& symbol_map)
+			: sinks_(chef::sinks_of(dfa, accepts))
+			, dfa_(&dfa)
+		{
+			for (auto const& [c, symbol] : symbol_map) {
+				byte_symbols_[static_cast<unsigned char>(c)] = symbol;
+			}
+		}
+
+		bool is_dead(chef::state_type state) const
+		{
+			return state == dfa_->dead_state() || sinks_[state] == chef::sink_kind::dead;
+		}
+
+		auto next(chef::state_type from, unsigned int byte) const -> std::optional<chef::state_type>
+		{
+			auto const symbol = byte_symbols_[byte];
+			if (!symbol) return std::nullopt;
+			chef::state_type const to = dfa_->process(from, *symbol);
+			if (is_dead(to)) return std::nullopt;
+			return to;
+		}
+	};
+
+#if CHEF_JIT_X86_64
+	// Just enough of an x86-64 assembler for the matchers.
+	class assembler {
+	private:
+		struct fixup {
+			std::size_t at;
+			std::size_t label;
+			// The 32-bit value written is (label - base).
+			std::size_t base;
+		};
+
+		static constexpr std::size_t unbound = std::size_t(-1);
+
+		std::vector<unsigned char> code_;
+		std::vector<std::size_t> labels_;
+		std::vector<fixup> fixups_;
+
+	public:
+		std::size_t new_label()
+		{
+			labels_.push_back(unbound);
+			return labels_.size() - 1;
+		}
+
+		void bind(std::size_t label)
+		{
+			labels_[label] = code_.size();
+		}
+
+		void emit(std::initializer_list<unsigned char> bytes)
+		{
+			code_.insert(code_.end(), bytes);
+		}
+
+		void imm32(std::uint32_t value)
+		{
+			for (int i = 0; i < 4; ++i) {
+				code_.push_back(static_cast<unsigned char>(value >> (8 * i)));
+			}
+		}
+
+		// A 32-bit displacement from the end of the instruction, which must end right after it.
+		void rel32(std::size_t label)
+		{
+			fixups_.push_back(fixup{.at = code_.size(), .label = label, .base = code_.size() + 4});
+			imm32(0);
+		}
+
+		// A 32-bit offset relative to `base_label`.
+		void offset32(std::size_t label, std::size_t base_label)
+		{
+			fixups_.push_back(
+				fixup{.at = code_.size(), .label = label, .base = labels_[base_label]});
+			imm32(0);
+		}
+
+		void align(std::size_t alignment)
+		{
+			while (code_.size() % alignment != 0) {
+				code_.push_back(0xCC); // int3
+			}
+		}
+
+		auto finish() -> std::vector<unsigned char>
+		{
+			for (auto const [at, label, base] : fixups_) {
+				auto const value = static_cast<std::uint32_t>(
+					static_cast<std::int32_t>(std::int64_t(labels_[label]) - std::int64_t(base)));
+				for (int i = 0; i < 4; ++i) {
+					code_[at + i] = static_cast<unsigned char>(value >> (8 * i));
+				}
+			}
+			return std::move(code_);
+		}
+	};
+
+	// States with more runs of bytes than this use a jump table.
+	constexpr std::size_t max_compare_chain = 8;
+
+	// Generates `bool match(unsigned char const* first, unsigned char const* last)`.
+	// (System V: `first` is in rdi and `last` is in rsi.)
+	auto assemble(chef::dfa const& dfa, byte_transitions const& transitions,
+		chef::category_view accepts) -> std::vector<unsigned char>
+	{
+		assembler a;
+
+		std::vector<std::size_t> state_labels(dfa.num_states());
+		for (auto& label : state_labels) {
+			label = a.new_label();
+		}
+		std::size_t const accept = a.new_label();
+		std::size_t const reject = a.new_label();
+
+		auto const target = [&](std::optional<chef::state_type> const next) {
+			return next ? state_labels[*next] : reject;
+		};
+
+		if (transitions.is_dead(0)) {
+			a.emit({0x31, 0xC0, 0xC3}); // xor eax, eax; ret
+			return a.finish();
+		}
+
+		for (chef::state_type const state : dfa.states()) {
+			if (transitions.is_dead(state)) continue;
+
+			a.bind(state_labels[state]);
+			a.emit({0x48, 0x39, 0xF7}); // cmp rdi, rsi
+			a.emit({0x0F, 0x84}); // je rel32
+			a.rel32(accepts.contains(state) ? accept : reject);
+			a.emit({0x0F, 0xB6, 0x07}); // movzx eax, byte [rdi]
+			a.emit({0x48, 0xFF, 0xC7}); // inc rdi
+
+			struct byte_run {
+				unsigned int hi;
+				std::size_t label;
+			};
+			std::vector<byte_run> runs;
+			for (unsigned int lo = 0; lo < 256;) {
+				std::size_t const label = target(transitions.next(state, lo));
+				unsigned int hi = lo;
+				while (hi + 1 < 256 && target(transitions.next(state, hi + 1)) == label) {
+					++hi;
+				}
+				runs.push_back(byte_run{.hi = hi, .label = label});
+				lo = hi + 1;
+			}
+
+			if (runs.size() <= max_compare_chain) {
+				// The runs are ascending, so each comparison only needs the upper bound.
+				for (std::size_t i = 0; i + 1 < runs.size(); ++i) {
+					a.emit({0x3D}); // cmp eax, imm32
+					a.imm32(runs[i].hi);
+					a.emit({0x0F, 0x86}); // jbe rel32
+					a.rel32(runs[i].label);
+				}
+				a.emit({0xE9}); // jmp rel32
+				a.rel32(runs.back().label);
+			} else {
+				std::size_t const table = a.new_label();
+				a.emit({0x48, 0x8D, 0x0D}); // lea rcx, [rip + table]
+				a.rel32(table);
+				a.emit({0x48, 0x63, 0x04, 0x81}); // movsxd rax, dword [rcx + rax*4]
+				a.emit({0x48, 0x01, 0xC8}); // add rax, rcx
+				a.emit({0xFF, 0xE0}); // jmp rax
+
+				a.align(4);
+				a.bind(table);
+				unsigned int byte = 0;
+				for (auto const& run : runs) {
+					for (; byte <= run.hi; ++byte) {
+						a.offset32(run.label, table);
+					}
+				}
+			}
+		}
+
+		a.bind(accept);
+		a.emit({0xB8}); // mov eax, 1
+		a.imm32(1);
+		a.emit({0xC3}); // ret
+
+		a.bind(reject);
+		a.emit({0x31, 0xC0, 0xC3}); // xor eax, eax; ret
+
+		return a.finish();
+	}
+#endif
+}
+
+namespace chef {
+	void jit_dfa::code_deleter::operator()(void* code) const
+	{
+#if CHEF_JIT_X86_64
+		::munmap(code, size);
+#else
+		(void)code;
+#endif
+	}
+
+	jit_dfa::jit_dfa(chef::dfa const& dfa, chef::category_view accepts,
+		std::unordered_map<char, chef::symbol_type> const& symbol_map, chef::jit_mode mode)
+		: code_(nullptr, code_deleter{0})
+		, reject_row_(std::size_t(dfa.num_states()) * 256)
+	{
+		if (mode == chef::jit_mode::native) {
+			compile_native(dfa, accepts, symbol_map);
+			if (native_) return;
+		}
+
+		byte_transitions const transitions(dfa, accepts, symbol_map);
+
+		byte_table_.resize(reject_row_ + 256, reject_row_);
+		for (chef::state_type const state : dfa.states()) {
+			for (unsigned int byte = 0; byte < 256; ++byte) {
+				if (auto const next = transitions.next(state, byte)) {
+					byte_table_[std::size_t(state) * 256 + byte] = std::size_t(*next) * 256;
+				}
+			}
+		}
+
+		row_accepts_.resize(dfa.num_states() + 1);
+		for (chef::state_type const state : accepts) {
+			row_accepts_[state] = true;
+		}
+	}
+
+	void jit_dfa::compile_native([[maybe_unused]] chef::dfa const& dfa,
+		[[maybe_unused]] chef::category_view accepts,
+		[[maybe_unused]] std::unordered_map<char, chef::symbol_type> const& symbol_map)
+	{
+#if CHEF_JIT_X86_64
+		std::vector<unsigned char> const code
+			= ::assemble(dfa, byte_transitions(dfa, accepts, symbol_map), accepts);
+
+		void* const memory = ::mmap(nullptr, code.size(), PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (memory == MAP_FAILED) return;
+		code_ = std::unique_ptr<void, code_deleter>(memory, code_deleter{code.size()});
+
+		std::memcpy(memory, code.data(), code.size());
+		if (::mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0) {
+			code_.reset();
+			return;
+		}
+
+		native_ = reinterpret_cast<native_fn>(memory);
+#endif
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <chef/dfa/categories.hpp>
+#include <chef/dfa/dfa.hpp>
+
+namespace chef {
+	enum class jit_mode {
+		// Compile to machine code if the host supports it, otherwise interpret.
+		native,
+		// Always use the portable table-driven matcher.
+		interpreted,
+	};
+
+	// A whole-string matcher for a DFA, compiled to x86-64 machine code when possible.
+	//
+	// The native code has one block per state. Each block dispatches on the input byte either
+	// with a chain of range comparisons (sparse states) or through a jump table (dense states),
+	// jumping directly into the next state's block. Transitions into dead states reject right
+	// away.
+	//
+	// Elsewhere (or with jit_mode::interpreted), this walks a byte-indexed table of
+	// premultiplied rows, which is one load per byte.
+	class jit_dfa {
+	private:
+		struct code_deleter {
+			std::size_t size;
+			void operator()(void* code) const;
+		};
+
+		using native_fn = bool (*)(unsigned char const* first, unsigned char const* last);
+
+		std::unique_ptr<void, code_deleter> code_;
+		native_fn native_ = nullptr;
+
+		// The portable matcher. Rows are premultiplied by 256; the last row is the reject state.
+		std::vector<std::size_t> byte_table_;
+		std::vector<bool> row_accepts_;
+		std::size_t reject_row_;
+
+	public:
+		explicit jit_dfa(chef::dfa const& dfa, chef::category_view accepts,
+			std::unordered_map<char, chef::symbol_type> const& symbol_map,
+			chef::jit_mode mode = chef::jit_mode::native);
+
+	public:
+		// Whether the matcher runs as native code.
+		bool is_native() const
+		{
+			return native_ != nullptr;
+		}
+
+		// Whether the whole string is in the language.
+		bool matches(std::string_view str) const
+		{
+			no_stats stats;
+			return matches(str, stats);
+		}
+
+		// As above, telling `stats` (a policy as in chef/re/engines/match_stats.hpp) of each
+		// lookup in the portable matcher's table. Native code doesn't use the table, so all of
+		// its bytes are told as skipped.
+		template <typename Stats>
+		bool matches(std::string_view str, Stats& stats) const
+		{
+			auto const* first = reinterpret_cast<unsigned char const*>(str.data());
+			if (native_) {
+				stats.skip(str.size());
+				return native_(first, first + str.size());
+			}
+
+			std::size_t row = 0;
+			for (auto const* last = first + str.size(); first != last; ++first) {
+				stats.transition();
+				row = byte_table_[row + *first];
+				if (row == reject_row_) return false;
+			}
+			return row_accepts_[row / 256];
+		}
+
+	private:
+		struct no_stats {
+			void transition() { }
+			void skip(std::size_t) { }
+		};
+
+		void compile_native(chef::dfa const& dfa,
+			chef::category_view accepts,
+			std::unordered_map<char, chef::symbol_type> const& symbol_map);
+	};
+}
@@ -0,0 +1,89 @@
+#include <chef/dfa/jit.hpp>
+
+#include <string>
+
+#include <catch2/catch.hpp>
+
+namespace {
+	// Accepts strings of 'a'..'z' with an even number of 'q's, over the symbols:
+	//  0: 'q'
+	//  1..25: the other letters
+	// Every state has 4 runs of bytes ("< a", "a..p", "q", ...), so uses a compare chain.
+	chef::dfa const even_qs = [] {
+		std::vector<chef::fa_edge> edges;
+		for (chef::symbol_type sym = 0; sym < 26; ++sym) {
+			edges.push_back({.from = 0, .to = chef::state_type(sym == 0 ? 1 : 0), .on = sym});
+			edges.push_back({.from = 1, .to = chef::state_type(sym == 0 ? 0 : 1), .on = sym});
+		}
+		return chef::dfa(2, 26, edges);
+	}();
+
+	std::unordered_map<char, chef::symbol_type> const letters = [] {
+		std::unordered_map<char, chef::symbol_type> result{{'q', 0}};
+		chef::symbol_type next = 1;
+		for (char c = 'a'; c <= 'z'; ++c) {
+			if (c != 'q') result.emplace(c, next++);
+		}
+		return result;
+	}();
+
+	// Accepts strings with an even number of 'a', 'c', 'e', ..., with a symbol for each letter.
+	// Every other letter changes the state, so there are many runs of bytes and each state uses
+	// a jump table.
+	chef::dfa const alternating = [] {
+		std::vector<chef::fa_edge> edges;
+		for (chef::symbol_type sym = 0; sym < 26; ++sym) {
+			bool const toggles = sym % 2 == 0;
+			edges.push_back({.from = 0, .to = chef::state_type(toggles ? 1 : 0), .on = sym});
+			edges.push_back({.from = 1, .to = chef::state_type(toggles ? 0 : 1), .on = sym});
+		}
+		return chef::dfa(2, 26, edges);
+	}();
+
+	std::unordered_map<char, chef::symbol_type> const alternating_symbols = [] {
+		std::unordered_map<char, chef::symbol_type> result;
+		for (char c = 'a'; c <= 'z'; ++c) {
+			result.emplace(c, static_cast<chef::symbol_type>(c - 'a'));
+		}
+		return result;
+	}();
+
+	// Both DFAs accept in their start state.
+	chef::state_categories const start_accepts(2, {{0}});
+}
+
+TEST_CASE("jit dfa matches with a compare chain", "[jit]")
+{
+	auto const mode = GENERATE(chef::jit_mode::native, chef::jit_mode::interpreted);
+	chef::jit_dfa const jit(even_qs, start_accepts[0], letters, mode);
+
+	CHECK(jit.matches(""));
+	CHECK(jit.matches("hello"));
+	CHECK(jit.matches("qq"));
+	CHECK(jit.matches("aqbcqz"));
+	CHECK_FALSE(jit.matches("q"));
+	CHECK_FALSE(jit.matches("quiz"));
+	CHECK_FALSE(jit.matches("hello world"));
+	CHECK_FALSE(jit.matches("HELLO"));
+}
+
+TEST_CASE("jit dfa matches with a jump table", "[jit]")
+{
+	auto const mode = GENERATE(chef::jit_mode::native, chef::jit_mode::interpreted);
+	chef::jit_dfa const jit(alternating, start_accepts[0], alternating_symbols, mode);
+
+	CHECK(jit.matches(""));
+	CHECK(jit.matches("bdf"));
+	CHECK(jit.matches("ac"));
+	CHECK(jit.matches("abcz"));
+	CHECK_FALSE(jit.matches("a"));
+	CHECK_FALSE(jit.matches("abcy"));
+	CHECK_FALSE(jit.matches(std::string("ac\0", 3)));
+	CHECK_FALSE(jit.matches("ac\xff"));
+}
+
+TEST_CASE("jit dfa can be forced to interpret", "[jit]")
+{
+	chef::jit_dfa const jit(even_qs, start_accepts[0], letters, chef::jit_mode::interpreted);
+	CHECK_FALSE(jit.is_native());
+}
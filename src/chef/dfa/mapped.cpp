@@ -0,0 +1,179 @@
+#include "./mapped.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <ostream>
+
+#include <chef/dfa/sinks.hpp>
+#include <chef/errors.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace chef {
+	namespace {
+		constexpr std::uint64_t section_alignment = 64;
+
+		// The byte order tag as read on a host with the other byte order.
+		constexpr std::uint32_t swapped_byte_order = 0x04030201;
+		static_assert(detail::mapped_dfa_header::expected_byte_order == 0x01020304);
+
+		auto align_up(std::uint64_t offset) -> std::uint64_t
+		{
+			return (offset + section_alignment - 1) / section_alignment * section_alignment;
+		}
+
+		void write_padding(std::ostream& out, std::uint64_t& offset, std::uint64_t to)
+		{
+			static constexpr std::array<char, section_alignment> zeros{};
+			out.write(zeros.data(), static_cast<std::streamsize>(to - offset));
+			offset = to;
+		}
+
+		// Whether [offset, offset + size) lies within the file.
+		bool in_bounds(std::uint64_t offset, std::uint64_t size, std::uint64_t file_size)
+		{
+			return offset <= file_size && size <= file_size - offset;
+		}
+	}
+
+	void save_dfa(std::ostream& out, chef::dfa const& dfa,
+		chef::state_categories const& categories,
+		std::unordered_map<char, chef::symbol_type> const& symbol_map)
+	{
+		detail::mapped_dfa_header header{};
+		std::ranges::copy(detail::mapped_dfa_header::expected_magic, header.magic);
+		header.byte_order = detail::mapped_dfa_header::expected_byte_order;
+		header.version = detail::mapped_dfa_header::current_version;
+		header.num_states = dfa.num_states();
+		header.num_categories = static_cast<std::uint32_t>(categories.size());
+		header.num_symbols = dfa.num_symbols();
+		header.stride2 = dfa.stride2();
+		header.row_width = dfa.visit_table(
+			[](auto const table) { return static_cast<std::uint8_t>(sizeof(table[0])); });
+
+		header.byte_map_offset = align_up(sizeof(header));
+		header.table_offset = align_up(header.byte_map_offset + 256);
+		header.table_size = dfa.visit_table([](auto const table) { return table.size_bytes(); });
+		header.sinks_offset = align_up(header.table_offset + header.table_size);
+		header.categories_offset = align_up(header.sinks_offset + dfa.num_states());
+		header.category_words = (std::uint64_t(dfa.num_states()) + 63) / 64;
+
+		std::array<unsigned char, 256> byte_map;
+		byte_map.fill(chef::no_symbol);
+		for (auto const& [c, symbol] : symbol_map) {
+			assert(symbol < dfa.num_symbols());
+			byte_map[static_cast<unsigned char>(c)] = symbol;
+		}
+
+		std::vector<chef::sink_kind> const sinks = chef::sinks_of(dfa, categories);
+
+		std::vector<std::uint64_t> category_bits(categories.size() * header.category_words);
+		for (std::size_t cat = 0; cat < categories.size(); ++cat) {
+			for (chef::state_type const state : categories[cat]) {
+				assert(state < dfa.num_states());
+				category_bits[cat * header.category_words + state / 64] |= std::uint64_t(1)
+					<< (state % 64);
+			}
+		}
+
+		std::uint64_t offset = 0;
+		out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+		offset += sizeof(header);
+
+		write_padding(out, offset, header.byte_map_offset);
+		out.write(reinterpret_cast<char const*>(byte_map.data()), byte_map.size());
+		offset += byte_map.size();
+
+		write_padding(out, offset, header.table_offset);
+		dfa.visit_table([&](auto const table) {
+			out.write(reinterpret_cast<char const*>(table.data()),
+				static_cast<std::streamsize>(table.size_bytes()));
+		});
+		offset += header.table_size;
+
+		write_padding(out, offset, header.sinks_offset);
+		out.write(reinterpret_cast<char const*>(sinks.data()),
+			static_cast<std::streamsize>(sinks.size()));
+		offset += sinks.size();
+
+		write_padding(out, offset, header.categories_offset);
+		out.write(reinterpret_cast<char const*>(category_bits.data()),
+			static_cast<std::streamsize>(category_bits.size() * sizeof(std::uint64_t)));
+	}
+
+	void mapped_dfa::mapping_deleter::operator()(void const* data) const
+	{
+		::munmap(const_cast<void*>(data), size);
+	}
+
+	mapped_dfa::mapped_dfa(std::string const& path)
+		: mapping_(nullptr, mapping_deleter{0})
+	{
+		int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) throw chef::construction_error("Cannot open DFA file: " + path);
+
+		struct ::stat st;
+		if (::fstat(fd, &st) != 0) {
+			::close(fd);
+			throw chef::construction_error("Cannot read DFA file: " + path);
+		}
+		auto const file_size = static_cast<std::uint64_t>(st.st_size);
+		if (file_size < sizeof(header_)) {
+			::close(fd);
+			throw chef::construction_error("Not a DFA file (too short): " + path);
+		}
+
+		void* const data = ::mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (data == MAP_FAILED) throw chef::construction_error("Cannot map DFA file: " + path);
+		mapping_ = std::unique_ptr<void const, mapping_deleter>(data, mapping_deleter{file_size});
+
+		auto const* const bytes = static_cast<unsigned char const*>(data);
+		std::memcpy(&header_, bytes, sizeof(header_));
+
+		if (!std::ranges::equal(header_.magic, detail::mapped_dfa_header::expected_magic)) {
+			throw chef::construction_error("Not a DFA file (bad magic): " + path);
+		}
+		if (header_.byte_order != detail::mapped_dfa_header::expected_byte_order) {
+			if (header_.byte_order == swapped_byte_order) {
+				throw chef::construction_error(
+					"DFA file was written on a host with a different byte order: " + path);
+			}
+			throw chef::construction_error("Not a DFA file (bad byte order tag): " + path);
+		}
+		if (header_.version != detail::mapped_dfa_header::current_version) {
+			throw chef::construction_error("Unsupported DFA file version "
+				+ std::to_string(header_.version) + ": " + path);
+		}
+
+		bool const valid_sizes = header_.num_states > 0
+			// Any uint8_t number of symbols is valid: the ids, at most 254, never reach
+			// chef::no_symbol.
+			&& header_.stride2 <= 8
+			&& (header_.row_width == 1 || header_.row_width == 2 || header_.row_width == 4)
+			&& header_.table_size
+				== (std::uint64_t(header_.num_states) << header_.stride2) * header_.row_width
+			&& header_.category_words == (std::uint64_t(header_.num_states) + 63) / 64;
+		bool const valid_sections = valid_sizes
+			&& in_bounds(header_.byte_map_offset, 256, file_size)
+			&& in_bounds(header_.table_offset, header_.table_size, file_size)
+			&& header_.table_offset % header_.row_width == 0
+			&& in_bounds(header_.sinks_offset, header_.num_states, file_size)
+			&& header_.categories_offset % alignof(std::uint64_t) == 0
+			&& header_.categories_offset <= file_size
+			&& header_.num_categories
+				<= (file_size - header_.categories_offset) / 8 / header_.category_words;
+		if (!valid_sizes || !valid_sections) {
+			throw chef::construction_error("Corrupt DFA file: " + path);
+		}
+
+		byte_map_ = bytes + header_.byte_map_offset;
+		table_ = bytes + header_.table_offset;
+		sinks_ = bytes + header_.sinks_offset;
+		categories_ = reinterpret_cast<std::uint64_t const*>(bytes + header_.categories_offset);
+	}
+}
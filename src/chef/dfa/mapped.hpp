@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <chef/_/fwd.hpp>
+#include <chef/_/ranges.hpp>
+#include <chef/dfa/categories.hpp>
+#include <chef/dfa/dfa.hpp>
+#include <chef/dfa/fa.hpp>
+
+// A binary format for compiled automata which is used in place, straight out of a read-only
+// mapping of the file. Many processes mapping the same file share one page-cache copy.
+//
+// Layout (all offsets are from the start of the file, so the data is position independent):
+//  - header: magic, byte order tag, format version, sizes and section offsets.
+//  - byte map: 256 bytes, the symbol for each input byte, or 0xFF for bytes outside of the
+//    alphabet.
+//  - transition table: chef::dfa's premultiplied table, in the same width.
+//  - sinks: one byte per state, its chef::sink_kind.
+//  - categories: one bitset over the states for each category, in 64-bit words.
+//
+// Sections are 64-byte aligned. Integers are in the byte order of the host which wrote the
+// file; loading a file written with the other byte order fails rather than byte swapping.
+
+namespace chef {
+	namespace detail {
+		struct mapped_dfa_header {
+			static constexpr char expected_magic[8] = {'C', 'H', 'E', 'F', 'D', 'F', 'A', '\0'};
+			static constexpr std::uint32_t expected_byte_order = 0x01020304;
+			static constexpr std::uint32_t current_version = 2;
+
+			char magic[8];
+			std::uint32_t byte_order;
+			std::uint32_t version;
+
+			std::uint32_t num_states;
+			std::uint32_t num_categories;
+			std::uint8_t num_symbols;
+			// log2 of the row length, as in chef::dfa.
+			std::uint8_t stride2;
+			// Bytes per transition table entry: 1, 2 or 4.
+			std::uint8_t row_width;
+			std::uint8_t reserved[5];
+
+			std::uint64_t byte_map_offset;
+			std::uint64_t table_offset;
+			std::uint64_t table_size;
+			std::uint64_t sinks_offset;
+			std::uint64_t categories_offset;
+			// 64-bit words per category.
+			std::uint64_t category_words;
+		};
+
+		static_assert(sizeof(mapped_dfa_header) == 80);
+	}
+
+	inline constexpr chef::symbol_type no_symbol = 0xFF;
+
+	/**
+	 * \brief Writes the DFA in the chef::mapped_dfa format
+	 *
+	 * \param out A binary stream
+	 * \param dfa
+	 * \param categories The states of each category (e.g. final states, token types). Their sinks
+	 * are saved as marked, or found if they are not marked.
+	 * \param symbol_map The symbol for each input character
+	 */
+	void save_dfa(std::ostream& out, chef::dfa const& dfa,
+		chef::state_categories const& categories,
+		std::unordered_map<char, chef::symbol_type> const& symbol_map);
+
+	// A DFA used directly from a memory-mapped file written by chef::save_dfa.
+	//
+	// Opening only validates the header, so it takes constant time however large the DFA is. The
+	// transitions themselves are trusted, so only load files written by chef::save_dfa.
+	class mapped_dfa {
+	private:
+		struct mapping_deleter {
+			std::size_t size;
+			void operator()(void const* data) const;
+		};
+
+		std::unique_ptr<void const, mapping_deleter> mapping_;
+		detail::mapped_dfa_header header_;
+		unsigned char const* byte_map_;
+		void const* table_;
+		unsigned char const* sinks_;
+		std::uint64_t const* categories_;
+
+	public:
+		// Maps the file. Throws chef::construction_error if it is not a valid file.
+		explicit mapped_dfa(std::string const& path);
+
+	public:
+		// Calls `f` with the transition table as a std::span of premultiplied states, as with
+		// chef::dfa::visit_table().
+		template <typename F>
+		decltype(auto) visit_table(F&& f) const
+		{
+			std::size_t const size = header_.table_size / header_.row_width;
+			switch (header_.row_width) {
+			case 1:
+				return CHEF_FWD(f)(
+					std::span(static_cast<std::uint8_t const*>(table_), size));
+			case 2:
+				return CHEF_FWD(f)(
+					std::span(static_cast<std::uint16_t const*>(table_), size));
+			default:
+				return CHEF_FWD(f)(
+					std::span(static_cast<std::uint32_t const*>(table_), size));
+			}
+		}
+
+		auto num_states() const -> state_type
+		{
+			return header_.num_states;
+		}
+
+		auto states() const
+		{
+			return std::ranges::views::iota(state_type(0), num_states());
+		}
+
+		auto num_symbols() const -> symbol_type
+		{
+			return header_.num_symbols;
+		}
+
+		auto symbols() const
+		{
+			return std::ranges::views::iota(symbol_type(0), num_symbols());
+		}
+
+		auto num_categories() const -> std::size_t
+		{
+			return header_.num_categories;
+		}
+
+		// The symbol for the input character, if it is in the alphabet.
+		auto symbol(char c) const -> std::optional<chef::symbol_type>
+		{
+			chef::symbol_type const sym = byte_map_[static_cast<unsigned char>(c)];
+			if (sym == chef::no_symbol) return std::nullopt;
+			return sym;
+		}
+
+		// As chef::dfa::process(): a partial DFA's dead transitions go to num_states().
+		auto process(state_type from, symbol_type on) const -> state_type
+		{
+			assert(from < num_states());
+			assert(on < num_symbols());
+
+			return visit_table([&](auto const table) {
+				std::size_t const row = std::size_t(from) << header_.stride2;
+				return static_cast<state_type>(table[row + on] >> header_.stride2);
+			});
+		}
+
+		// The sink kind of the state, as marked when the file was saved.
+		auto sink(state_type state) const -> chef::sink_kind
+		{
+			assert(state < num_states());
+			return static_cast<chef::sink_kind>(sinks_[state]);
+		}
+
+		bool in_category(std::size_t category, state_type state) const
+		{
+			assert(category < num_categories());
+			assert(state < num_states());
+
+			return (categories_[category * header_.category_words + state / 64] >> (state % 64))
+				& 1;
+		}
+
+		// Whether the whole string ends in a state of the category. Stops early once a sink is
+		// reached.
+		bool matches(std::string_view str, std::size_t category = 0) const
+		{
+			std::size_t const row = visit_table([&](auto const table) -> std::size_t {
+				std::size_t row = 0;
+				for (auto first = str.begin(); first != str.end(); ++first) {
+					// Stop as soon as the rest of the input can't change the answer.
+					auto const sink = static_cast<chef::sink_kind>(sinks_[row >> header_.stride2]);
+					if (sink == chef::sink_kind::dead) return std::size_t(-1);
+					if (sink == chef::sink_kind::accept_forever) {
+						// Characters outside of the alphabet still fail the match.
+						bool const in_alphabet = std::all_of(first, str.end(),
+							[&](char const c) { return symbol(c).has_value(); });
+						return in_alphabet ? row : std::size_t(-1);
+					}
+
+					chef::symbol_type const sym = byte_map_[static_cast<unsigned char>(*first)];
+					if (sym == chef::no_symbol) return std::size_t(-1);
+					row = table[row + sym];
+					// A partial DFA's dead state has no row.
+					if (row == table.size()) return std::size_t(-1);
+				}
+				return row;
+			});
+			if (row == std::size_t(-1)) return false;
+			return in_category(category, static_cast<state_type>(row >> header_.stride2));
+		}
+	};
+}
@@ -0,0 +1,149 @@
+#include <chef/dfa/mapped.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+
+#include <chef/errors.hpp>
+
+#include <catch2/catch.hpp>
+
+namespace {
+	// A uniquely named file in the temporary directory, removed at the end of the test.
+	// The random suffix keeps concurrent test runs from sharing the file.
+	struct temp_file {
+		std::string path;
+
+		explicit temp_file(std::string const& name)
+		{
+			auto const unique_name = name + '.' + std::to_string(std::random_device()());
+			path = (std::filesystem::temp_directory_path() / unique_name).string();
+		}
+
+		~temp_file()
+		{
+			std::error_code ignored;
+			std::filesystem::remove(path, ignored);
+		}
+	};
+
+	void save(std::string const& path, chef::dfa const& dfa,
+		chef::state_categories const& categories,
+		std::unordered_map<char, chef::symbol_type> const& symbol_map)
+	{
+		std::ofstream out(path, std::ios::binary);
+		chef::save_dfa(out, dfa, categories, symbol_map);
+	}
+}
+
+TEST_CASE("mapped_dfa matches like the saved dfa")
+{
+	// Accepts a(b)*, over the symbols {a: 0, b: 1}. State 2 is dead.
+	auto const dfa = chef::dfa(3, 2,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 0, .to = 2, .on = 1},
+			{.from = 1, .to = 2, .on = 0},
+			{.from = 1, .to = 1, .on = 1},
+			{.from = 2, .to = 2, .on = 0},
+			{.from = 2, .to = 2, .on = 1},
+		});
+	chef::state_categories const categories(3, {{1}, {2}});
+	std::unordered_map<char, chef::symbol_type> const symbol_map{{'a', 0}, {'b', 1}};
+
+	temp_file const file("chef-mapped-dfa.test");
+	save(file.path, dfa, categories, symbol_map);
+	chef::mapped_dfa const mapped(file.path);
+
+	CHECK(mapped.num_states() == 3);
+	CHECK(mapped.num_symbols() == 2);
+	CHECK(mapped.num_categories() == 2);
+	for (chef::state_type const from : dfa.states()) {
+		for (chef::symbol_type const on : dfa.symbols()) {
+			CHECK(mapped.process(from, on) == dfa.process(from, on));
+		}
+	}
+
+	CHECK(mapped.symbol('b') == chef::symbol_type(1));
+	CHECK(mapped.symbol('c') == std::nullopt);
+
+	CHECK(mapped.matches("a"));
+	CHECK(mapped.matches("abbb"));
+	CHECK_FALSE(mapped.matches(""));
+	CHECK_FALSE(mapped.matches("aba"));
+	CHECK_FALSE(mapped.matches("abc"));
+	CHECK(mapped.matches("aba", 1));
+
+	// State 2 is only ever in category 1, so matching stops there, but still checks the bytes.
+	CHECK(mapped.sink(0) == chef::sink_kind::none);
+	CHECK(mapped.sink(2) == chef::sink_kind::accept_forever);
+	CHECK(mapped.matches("babab", 1));
+	CHECK_FALSE(mapped.matches("babac", 1));
+}
+
+TEST_CASE("mapped_dfa keeps wide tables")
+{
+	// A cycle of 300 states on symbol 0, which needs 16-bit rows.
+	std::vector<chef::fa_edge> edges;
+	for (chef::state_type state = 0; state < 300; ++state) {
+		edges.push_back({.from = state, .to = chef::state_type((state + 1) % 300), .on = 0});
+	}
+	auto const dfa = chef::dfa(300, 1, edges);
+	chef::state_categories const categories(300, {{0}, {299}});
+
+	temp_file const file("chef-mapped-dfa-wide.test");
+	save(file.path, dfa, categories, {{'x', 0}});
+	chef::mapped_dfa const mapped(file.path);
+
+	CHECK(mapped.visit_table([](auto const table) { return sizeof(table[0]); }) == 2);
+	CHECK(mapped.process(299, 0) == 0);
+	CHECK(mapped.matches(std::string(600, 'x'), 0));
+	CHECK(mapped.matches(std::string(299, 'x'), 1));
+	CHECK_FALSE(mapped.matches(std::string(298, 'x'), 1));
+}
+
+TEST_CASE("mapped_dfa loads the most symbols save_dfa writes")
+{
+	// One state which loops on every one of 255 symbols.
+	std::vector<chef::fa_edge> edges;
+	std::unordered_map<char, chef::symbol_type> symbol_map;
+	for (chef::symbol_type on = 0; on < 255; ++on) {
+		edges.push_back({.from = 0, .to = 0, .on = on});
+		symbol_map.emplace(static_cast<char>(on), on);
+	}
+	auto const dfa = chef::dfa(1, 255, edges);
+	chef::state_categories const categories(1, {{0}});
+
+	temp_file const file("chef-mapped-dfa-symbols.test");
+	save(file.path, dfa, categories, symbol_map);
+	chef::mapped_dfa const mapped(file.path);
+
+	CHECK(mapped.num_symbols() == 255);
+	CHECK(mapped.matches("\x01\xFE", 0));
+	CHECK_FALSE(mapped.matches("\xFF", 0));
+}
+
+TEST_CASE("mapped_dfa rejects invalid files")
+{
+	temp_file const file("chef-mapped-dfa-invalid.test");
+
+	SECTION("missing")
+	{
+		CHECK_THROWS_AS(chef::mapped_dfa(file.path), chef::construction_error);
+	}
+
+	SECTION("not a dfa")
+	{
+		std::ofstream(file.path, std::ios::binary) << std::string(200, 'x');
+		CHECK_THROWS_AS(chef::mapped_dfa(file.path), chef::construction_error);
+	}
+
+	SECTION("truncated")
+	{
+		auto const dfa = chef::dfa(1, 1, {{.from = 0, .to = 0, .on = 0}});
+		save(file.path, dfa, chef::state_categories(1, {{0}}), {{'x', 0}});
+		std::filesystem::resize_file(file.path, sizeof(chef::detail::mapped_dfa_header) + 8);
+		CHECK_THROWS_AS(chef::mapped_dfa(file.path), chef::construction_error);
+	}
+}
@@ -1,228 +1,413 @@
 #pragma once
 
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
-#include <functional>
-#include <numeric>
-#include <unordered_map>
-#include <unordered_set>
+#include <span>
 #include <utility>
 #include <vector>
 
-#include <tl/tl.hpp>
-
 #include <chef/_/fwd.hpp>
+#include <chef/_/memory.hpp>
 #include <chef/_/ranges.hpp>
-#include <chef/_/set.hpp>
+#include <chef/dfa/categories.hpp>
 #include <chef/dfa/dfa.hpp>
+#include <chef/dfa/prune.hpp>
+#include <chef/dfa/sinks.hpp>
+#include <chef/dfa/stats.hpp>
 
 namespace chef {
 	namespace detail {
-		struct commutative_set_hash {
-			template <std::convertible_to<std::size_t> T>
-			std::size_t operator()(std::unordered_set<T> const& states) const
+		// A partition of the states [0, n) into blocks which can be refined in time proportional to
+		// the number of states marked (Valmari and Lehtinen's refinable partition).
+		//
+		// The states of each block are contiguous in `elements_`, with the marked ones first.
+		class refinable_partition {
+		private:
+			std::vector<state_type> elements_;
+			// The index of each state in elements_.
+			std::vector<std::size_t> position_;
+			std::vector<std::size_t> block_of_;
+			// Block `b` is elements_[first_[b]..end_[b]), of which [first_[b], marked_end_[b]) are
+			// marked.
+			std::vector<std::size_t> first_;
+			std::vector<std::size_t> end_;
+			std::vector<std::size_t> marked_end_;
+			// The blocks with marked states.
+			std::vector<std::size_t> touched_;
+
+		public:
+			// A single block of every state.
+			explicit refinable_partition(state_type num_states)
+				: elements_(num_states)
+				, position_(num_states)
+				, block_of_(num_states)
+				, first_({0})
+				, end_({num_states})
+				, marked_end_({0})
 			{
-				using namespace std::ranges;
+				for (state_type state = 0; state < num_states; ++state) {
+					elements_[state] = state;
+					position_[state] = state;
+				}
+				if (num_states == 0) {
+					first_.clear();
+					end_.clear();
+					marked_end_.clear();
+				}
+			}
 
-				// FNV offset basis, just to give some entropy into the system:
-				std::size_t const offset = sizeof(std::size_t) == sizeof(std::uint32_t)
-					? 0x811c9dc5
-					: 0xcbf29ce484222325ull;
-				// FNV prime, just to give some entropy into the system:
-				std::size_t const prime = sizeof(std::size_t) == sizeof(std::uint32_t)
-					? 0x01000193
-					: 0x00000100000001b3ull;
+			auto num_blocks() const -> std::size_t
+			{
+				return first_.size();
+			}
 
-				auto adjusted = views::common(views::transform(
-					states, [prime](auto x) -> std::size_t { return prime * (x + 1); }));
+			auto block_of(state_type state) const -> std::size_t
+			{
+				return block_of_[state];
+			}
 
-				// Note: plus would be likely be a very bad hash because of the Central Limit
-				// Theorem. Basically, plus would make collisions _very likely_.
-				return std::accumulate(adjusted.begin(), adjusted.end(), offset, std::bit_xor{});
+			auto block_size(std::size_t block) const -> std::size_t
+			{
+				return end_[block] - first_[block];
 			}
-		};
 
-		template <typename K, typename Hash = std::hash<K>>
-		using hashset = std::unordered_set<K, Hash>;
+			// The states of the block, in no particular order.
+			auto states(std::size_t block) const -> std::span<state_type const>
+			{
+				return std::span<state_type const>(elements_).subspan(
+					first_[block], block_size(block));
+			}
 
-		template <typename K>
-		using comm_hashset = hashset<K, commutative_set_hash>;
+			void mark(state_type state)
+			{
+				std::size_t const block = block_of_[state];
+				std::size_t const pos = position_[state];
+				if (pos < marked_end_[block]) return; // Already marked
+
+				if (marked_end_[block] == first_[block]) touched_.push_back(block);
+
+				// Swap it into the marked part.
+				std::size_t const to = marked_end_[block]++;
+				state_type const other = elements_[to];
+				elements_[to] = state;
+				position_[state] = to;
+				elements_[pos] = other;
+				position_[other] = pos;
+			}
 
-		template <typename K, typename V, typename Hash = std::hash<K>>
-		using hashmap = std::unordered_map<K, V, Hash>;
+			// Splits the marked states of each block into their own block, unless the whole block
+			// is marked, and unmarks everything. Calls `on_split(old_block, new_block)` for each
+			// split.
+			template <typename F>
+			void split(F&& on_split)
+			{
+				for (std::size_t const block : touched_) {
+					std::size_t const mid = marked_end_[block];
+					marked_end_[block] = first_[block];
+					if (mid == end_[block]) continue;
+
+					std::size_t const new_block = num_blocks();
+					first_.push_back(first_[block]);
+					end_.push_back(mid);
+					marked_end_.push_back(first_[block]);
+					first_[block] = mid;
+					marked_end_[block] = mid;
+					for (std::size_t i = first_[new_block]; i < mid; ++i) {
+						block_of_[elements_[i]] = new_block;
+					}
+
+					on_split(block, new_block);
+				}
+				touched_.clear();
+			}
 
-		template <typename K, typename V>
-		using comm_hashmap = hashmap<K, V, commutative_set_hash>;
+			auto memory_bytes() const -> std::size_t
+			{
+				return detail::heap_bytes(elements_) + detail::heap_bytes(position_)
+					+ detail::heap_bytes(block_of_) + detail::heap_bytes(first_)
+					+ detail::heap_bytes(end_) + detail::heap_bytes(marked_end_)
+					+ detail::heap_bytes(touched_);
+			}
+		};
 
-		template <typename IndexType = std::size_t>
-		auto transpose(auto init, std::ranges::range auto const& map2d, auto const& insert_f)
+		// The number of states, counting a partial DFA's dead state as a real one.
+		inline auto num_states_with_dead(chef::dfa const& dfa) -> state_type
 		{
-			for (IndexType const index : detail::indices<IndexType>(map2d)) {
-				for (auto const second : map2d[index]) {
-					insert_f(init[second], index);
-				}
-			}
-			return init;
+			return dfa.num_states() + dfa.is_partial();
 		}
 
-		inline comm_hashset<hashset<chef::state_type>> get_minimization_partitions(
-			chef::dfa const& dfa,
-			// Each hashset lists the states in that category
-			std::vector<hashset<chef::state_type>> const& categories)
+		// As dfa.process(), where the dead state goes to itself.
+		inline auto successor(chef::dfa const& dfa, state_type from, symbol_type on) -> state_type
 		{
-			// What are the categories each state belongs to?
-			auto const transposed_cats
-				= detail::transpose(std::vector<hashset<std::size_t>>(dfa.num_states()), categories,
-					[] TL(_1.insert(_2)));
+			return from == dfa.dead_state() ? from : dfa.process(from, on);
+		}
 
-			// How many kinds of categories are there?
-			// Simultaneously store which states have the keyed category.
-			comm_hashmap<hashset<std::size_t>, hashset<chef::state_type>> unique_cats;
-			for (chef::state_type const state : dfa.states()) {
-				unique_cats[transposed_cats[state]].insert(state);
+		// For each symbol and state (including a partial DFA's dead state), the states which go to
+		// it on the symbol.
+		class inverse_transitions {
+		private:
+			// The predecessors of `to` on `on` are sources_[offsets_[i]..offsets_[i + 1]) for
+			// i = on * num_states + to.
+			std::vector<std::size_t> offsets_;
+			std::vector<state_type> sources_;
+			state_type num_states_;
+
+		public:
+			explicit inverse_transitions(chef::dfa const& dfa)
+				: offsets_(std::size_t(dfa.num_symbols()) * num_states_with_dead(dfa) + 1)
+				, sources_(std::size_t(dfa.num_symbols()) * num_states_with_dead(dfa))
+				, num_states_(num_states_with_dead(dfa))
+			{
+				for (state_type from = 0; from < num_states_; ++from) {
+					for (symbol_type const on : dfa.symbols()) {
+						++offsets_[index(detail::successor(dfa, from, on), on) + 1];
+					}
+				}
+				for (std::size_t i = 1; i < offsets_.size(); ++i) {
+					offsets_[i] += offsets_[i - 1];
+				}
+
+				std::vector<std::size_t> fill(offsets_.begin(), offsets_.end() - 1);
+				for (state_type from = 0; from < num_states_; ++from) {
+					for (symbol_type const on : dfa.symbols()) {
+						sources_[fill[index(detail::successor(dfa, from, on), on)]++] = from;
+					}
+				}
 			}
 
-			namespace views = std::ranges::views;
+			auto operator()(state_type to, symbol_type on) const -> std::span<state_type const>
+			{
+				std::size_t const i = index(to, on);
+				return std::span<state_type const>(sources_).subspan(
+					offsets_[i], offsets_[i + 1] - offsets_[i]);
+			}
 
-			auto values = views::common(views::values(unique_cats));
+			auto memory_bytes() const -> std::size_t
+			{
+				return detail::heap_bytes(offsets_) + detail::heap_bytes(sources_);
+			}
 
-			return comm_hashset<hashset<chef::state_type>>(
-				std::move_iterator(values.begin()), std::move_iterator(values.end()));
-		}
+		private:
+			auto index(state_type to, symbol_type on) const -> std::size_t
+			{
+				return std::size_t(on) * num_states_ + to;
+			}
+		};
 
-		inline std::vector<hashset<chef::state_type>> hopcroft(chef::dfa const& dfa,
-			std::vector<std::unordered_set<chef::state_type>> const& categories)
+		// Splits the states into blocks by the set of categories they belong to. A partial DFA's
+		// dead state is in none.
+		inline void partition_by_categories(
+			refinable_partition& partition, chef::state_categories const& categories)
 		{
-			namespace views = std::ranges::views;
-			// Implements DFA minimization by Hopcroft's algorithm.
-			// Note: single-letter capital "variable names" (sometimes comments) come from
-			// Wikipedia's psuedocode.
-
-			// Form initial partitions
-			// P
-			comm_hashset<hashset<chef::state_type>> partitions
-				= detail::get_minimization_partitions(dfa, categories);
-			// W
-			comm_hashset<hashset<chef::state_type>> work_partitions = partitions;
-
-			std::vector<hashset<chef::state_type>> new_partitions;
-
-			while (!work_partitions.empty()) {
-				// Pop a partition from W
-				hashset<chef::state_type> A = CHEF_MOVE(*work_partitions.begin());
-				work_partitions.erase(work_partitions.begin());
-
-				for (chef::symbol_type const sym : dfa.symbols()) {
-					// States which go into A on sym
-					auto X = detail::to_container<std::unordered_set>(
-						dfa.states() | views::filter([&] TL(A.contains(dfa.process(_1, sym)))));
-
-					// for-each, but erase sometimes
-					std::erase_if(partitions, [&](hashset<chef::state_type> const& Y) {
-						if (detail::has_intersect(X, Y)) {
-							if (auto diff = detail::difference(Y, X); !diff.empty()) {
-								auto intersect = detail::intersect(X, Y);
-
-								if (work_partitions.contains(Y)) {
-									work_partitions.erase(Y);
-									work_partitions.insert(diff);
-									work_partitions.insert(intersect);
-								} else {
-									work_partitions.insert(
-										intersect.size() <= diff.size() ? intersect : diff);
-								}
-
-								new_partitions.push_back(CHEF_MOVE(diff));
-								new_partitions.push_back(CHEF_MOVE(intersect));
-								return true; // Erase this set
-							}
-						}
-						return false;
-					});
-					partitions.insert(std::move_iterator(new_partitions.begin()),
-						std::move_iterator(new_partitions.end()));
-					new_partitions.clear();
+			// Sorting the states by their categories makes each set of categories one run.
+			std::vector<state_type> states;
+			for (state_type state = 0; state < categories.num_states(); ++state) {
+				if (categories.first(state)) states.push_back(state);
+			}
+			std::ranges::sort(states, [&](state_type lhs, state_type rhs) {
+				return std::ranges::lexicographical_compare(
+					categories.row(lhs), categories.row(rhs));
+			});
+
+			for (std::size_t first = 0; first < states.size();) {
+				std::size_t last = first + 1;
+				while (last < states.size()
+					&& categories.same_categories(states[first], states[last])) {
+					++last;
 				}
+				for (std::size_t i = first; i < last; ++i) {
+					partition.mark(states[i]);
+				}
+				partition.split([](std::size_t, std::size_t) { });
+				first = last;
 			}
+		}
 
-			// Translate partitions to an indexable form
-			std::vector<hashset<chef::state_type>> partitions_vec;
-			partitions_vec.reserve(partitions.size());
-			std::move(partitions.begin(), partitions.end(), std::back_inserter(partitions_vec));
-
-			if (!partitions_vec.empty()) { // should always be true
-				// The state with 0 is the start state.
-				// This state must be at index 0 in the vector so that we maintain start == 0.
-				auto it = std::find_if(
-					partitions_vec.begin(), partitions_vec.end(), [] TL(_1.contains(0)));
-				assert(it != partitions_vec.end() && "DFA is in an invalid state");
-				std::iter_swap(partitions_vec.begin(), it);
+		// Numbers the blocks by their lowest state, so that the start state's block is 0 and the
+		// numbering does not depend on how the partition was found. `block_of` has the block of
+		// each state, then of the dead state if the DFA is partial; blocks are numbered below
+		// block_of.size().
+		//
+		// The dead state's block stays implicit: its states all become the new DFA's dead state,
+		// unless the start state is one of them.
+		//
+		// Returns the new state of each state in `block_of`, and the number of new states.
+		inline auto number_blocks(chef::dfa const& dfa, std::span<std::size_t const> block_of)
+			-> std::pair<std::vector<state_type>, state_type>
+		{
+			bool const implicit_dead = dfa.is_partial()
+				&& block_of[dfa.dead_state()] != block_of[0];
+			auto const is_dead = [&](state_type state) {
+				return implicit_dead && block_of[state] == block_of[dfa.dead_state()];
+			};
+
+			constexpr auto unnumbered = state_type(-1);
+			std::vector<state_type> block_numbers(block_of.size(), unnumbered);
+			state_type num_blocks = 0;
+			for (state_type const state : dfa.states()) {
+				if (is_dead(state)) continue;
+				state_type& number = block_numbers[block_of[state]];
+				if (number == unnumbered) number = num_blocks++;
 			}
 
-			return partitions_vec;
+			std::vector<state_type> new_state_map(block_of.size());
+			for (std::size_t state = 0; state < block_of.size(); ++state) {
+				new_state_map[state] = is_dead(static_cast<state_type>(state))
+					? num_blocks
+					: block_numbers[block_of[state]];
+			}
+			return {CHEF_MOVE(new_state_map), num_blocks};
 		}
 
-		inline std::vector<chef::state_type> hopcroft_new_state_map(
-			chef::dfa const& dfa, std::vector<hashset<chef::state_type>> const& partitions)
+		// Builds the quotient DFA, given the new state of each old state. Old states which map to
+		// `num_new_states` become the new DFA's dead state.
+		inline auto quotient(chef::dfa const& dfa, chef::state_categories const& categories,
+			std::vector<state_type> const& new_state_map, state_type num_new_states)
+			-> std::pair<chef::dfa, chef::state_categories>
 		{
-			return detail::transpose<chef::state_type>(
-				std::vector<chef::state_type>(dfa.num_states()), partitions, [] TL(_1 = _2));
+			std::vector<state_type> table(std::size_t(num_new_states) * dfa.num_symbols());
+			chef::state_categories new_categories(num_new_states, categories.num_categories());
+			std::vector<bool> done(num_new_states);
+			for (state_type const old_from : dfa.states()) {
+				state_type const new_from = new_state_map[old_from];
+				if (new_from == num_new_states || done[new_from]) continue;
+				done[new_from] = true;
+				// The states of a block share their categories.
+				new_categories.insert_all(new_from, categories.row(old_from));
+
+				for (symbol_type const sym : dfa.symbols()) {
+					table[std::size_t(new_from) * dfa.num_symbols() + sym]
+						= new_state_map[dfa.process(old_from, sym)];
+				}
+			}
+
+			chef::dfa new_dfa(num_new_states, dfa.num_symbols(), table);
+			chef::mark_sinks(new_dfa, new_categories);
+			return std::pair{CHEF_MOVE(new_dfa), CHEF_MOVE(new_categories)};
 		}
 
-		inline chef::dfa hopcroft_to_dfa(chef::dfa const& old_dfa,
-			chef::state_type const num_states,
-			std::vector<hashset<chef::state_type>> const& partitions,
-			std::vector<chef::state_type> const& new_state_map)
+		// Implements DFA minimization by Hopcroft's algorithm, in O(n k log n). Returns the
+		// block of each state.
+		inline auto hopcroft(chef::dfa const& dfa, chef::state_categories const& categories,
+			chef::construction_stats* stats = nullptr) -> refinable_partition
 		{
-			// Construct edge list for new DFA
-			std::vector<fa_edge> edges;
-			for (auto const new_from : detail::indices<chef::state_type>(partitions)) {
-				for (chef::symbol_type const sym : old_dfa.symbols()) {
-					chef::state_type const old_from = *partitions[new_from].begin();
-					chef::state_type const old_to = old_dfa.process(old_from, sym);
-					chef::state_type const new_to = new_state_map[old_to];
-
-					edges.push_back(fa_edge{
-						.from = new_from,
-						.to = new_to,
-						.on = sym,
-					});
+			refinable_partition partition(detail::num_states_with_dead(dfa));
+			detail::partition_by_categories(partition, categories);
+			std::size_t const initial_blocks = partition.num_blocks();
+
+			inverse_transitions const inverse(dfa);
+			std::size_t const num_symbols = dfa.num_symbols();
+
+			// The splitters yet to be processed, as (block, symbol) pairs.
+			std::vector<std::pair<std::size_t, symbol_type>> work;
+			// Whether (block, symbol) is in `work`, at block * num_symbols + symbol.
+			std::vector<bool> in_work;
+
+			auto const add_work = [&](std::size_t block, symbol_type sym) {
+				std::size_t const index = block * num_symbols + sym;
+				if (index >= in_work.size()) in_work.resize(partition.num_blocks() * num_symbols);
+				if (in_work[index]) return;
+				in_work[index] = true;
+				work.emplace_back(block, sym);
+			};
+
+			// Every block but one is enough: splitting by the rest also splits by the last one.
+			if (partition.num_blocks() > 0) {
+				std::size_t largest = 0;
+				for (std::size_t block = 1; block < partition.num_blocks(); ++block) {
+					if (partition.block_size(block) > partition.block_size(largest)) {
+						largest = block;
+					}
+				}
+				for (std::size_t block = 0; block < partition.num_blocks(); ++block) {
+					if (block == largest) continue;
+					for (symbol_type const sym : dfa.symbols()) {
+						add_work(block, sym);
+					}
+				}
+			}
+
+			std::vector<state_type> predecessors;
+			while (!work.empty()) {
+				auto const [splitter, sym] = work.back();
+				work.pop_back();
+				in_work[splitter * num_symbols + sym] = false;
+
+				// Collect first: marking reorders states within blocks, possibly the splitter.
+				predecessors.clear();
+				for (state_type const to : partition.states(splitter)) {
+					auto const from = inverse(to, sym);
+					predecessors.insert(predecessors.end(), from.begin(), from.end());
+				}
+				for (state_type const from : predecessors) {
+					partition.mark(from);
 				}
+
+				partition.split([&](std::size_t old_block, std::size_t new_block) {
+					for (symbol_type const on : dfa.symbols()) {
+						std::size_t const index = old_block * num_symbols + on;
+						// If the old block is still to be processed, both halves must be.
+						// Otherwise, the smaller half is enough.
+						if (index < in_work.size() && in_work[index]) {
+							add_work(new_block, on);
+						} else if (partition.block_size(new_block)
+							<= partition.block_size(old_block))
+						{
+							add_work(new_block, on);
+						} else {
+							add_work(old_block, on);
+						}
+					}
+				});
 			}
 
-			return chef::dfa(num_states, old_dfa.num_symbols(), CHEF_MOVE(edges));
+			if (stats) {
+				stats->refinement_splits += partition.num_blocks() - initial_blocks;
+				stats->note_bytes(partition.memory_bytes() + inverse.memory_bytes()
+					+ detail::heap_bytes(work) + detail::heap_bytes(in_work)
+					+ detail::heap_bytes(predecessors));
+			}
+			return partition;
 		}
 	}
 
 	/**
 	 * \brief Minimizes the DFA into a DFA with the minimum number of states
 	 *
+	 * Unreachable states are pruned first. The new states are numbered in the order of the
+	 * lowest old state they contain, so the start state is still 0.
+	 *
+	 * A partial DFA is minimized as if its dead state were real (as in Valmari and Lehtinen's
+	 * algorithm for partial DFAs). The states equivalent to it are then dropped, so the result
+	 * is partial as well.
+	 *
+	 * The sinks of the result are marked, as with chef::mark_sinks().
+	 *
 	 * \param dfa
 	 * \param categories Predefined categories that distinguish states (e.g. final vs. non-final)
+	 * \param stats If not null, is filled in with the cost of minimizing
 	 */
-	inline std::pair<chef::dfa, std::vector<std::unordered_set<chef::state_type>>> minimize(
-		chef::dfa const& dfa, std::vector<std::unordered_set<chef::state_type>> const& categories)
+	inline std::pair<chef::dfa, chef::state_categories> minimize(chef::dfa const& dfa,
+		chef::state_categories const& categories, chef::construction_stats* stats = nullptr)
 	{
-		using detail::hashset;
+		detail::phase_timer const timer(stats, &chef::construction_stats::minimize_time);
+		// Unreachable states would only be carried along. A complete DFA stays complete.
+		auto const [pruned_dfa, pruned_categories] = chef::prune(dfa, categories,
+			dfa.is_partial() ? chef::dfa_kind::partial : chef::dfa_kind::complete);
 
-		std::vector<hashset<chef::state_type>> const partitions = detail::hopcroft(dfa, categories);
+		detail::refinable_partition const partition
+			= detail::hopcroft(pruned_dfa, pruned_categories, stats);
 
-		// Map [old state] -> [new state]
-		std::vector<chef::state_type> const new_state_map
-			= detail::hopcroft_new_state_map(dfa, partitions);
-
-		// Translate new DFA
-		auto new_dfa = detail::hopcroft_to_dfa(
-			dfa, static_cast<chef::state_type>(partitions.size()), partitions, new_state_map);
-
-		// Track categories for new DFA
-		std::vector<hashset<chef::state_type>> new_categories(categories.size());
-		for (std::size_t const cat_index : detail::indices(categories)) {
-			std::transform(categories[cat_index].begin(), categories[cat_index].end(),
-				std::inserter(new_categories[cat_index], new_categories[cat_index].end()),
-				[&] TL(new_state_map[_1]));
+		std::vector<std::size_t> block_of(detail::num_states_with_dead(pruned_dfa));
+		for (std::size_t state = 0; state < block_of.size(); ++state) {
+			block_of[state] = partition.block_of(static_cast<chef::state_type>(state));
 		}
 
-		return std::pair{CHEF_MOVE(new_dfa), CHEF_MOVE(new_categories)};
+		// Map [old state] -> [new state]
+		auto const [new_state_map, num_new_states] = detail::number_blocks(pruned_dfa, block_of);
+		if (stats) stats->minimized_states = num_new_states;
+
+		return detail::quotient(pruned_dfa, pruned_categories, new_state_map, num_new_states);
 	}
 }
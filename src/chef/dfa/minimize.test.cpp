@@ -1,5 +1,8 @@
 #include "./minimize.hpp"
 
+#include <map>
+#include <optional>
+#include <random>
 #include <ranges>
 #include <set>
 
@@ -50,7 +53,7 @@ TEST_CASE("dfa minimization works")
 			{.from = 3, .to = 0, .on = 1},
 		});
 
-	auto [dfa, categories] = chef::minimize(dfa_in, {{2}});
+	auto [dfa, categories] = chef::minimize(dfa_in, chef::state_categories(4, {{2}}));
 
 	CHECK(dfa.num_symbols() == 2);
 
@@ -93,7 +96,7 @@ TEST_CASE("dfa minimization works - Wikipedia example")
 			{.from = 5, .to = 5, .on = 1},
 		});
 
-	auto [dfa, categories] = chef::minimize(dfa_in, {{2, 3, 4}});
+	auto [dfa, categories] = chef::minimize(dfa_in, chef::state_categories(6, {{2, 3, 4}}));
 
 	CHECK(dfa.num_symbols() == 2);
 	CHECK(dfa.num_states() == 3);
@@ -157,7 +160,8 @@ TEST_CASE("dfa minimization works - difference mod 4")
 			{.from = 0b11'11, .to = 0b00'11, .on = 1},
 		});
 
-	auto [dfa, categories] = chef::minimize(dfa_in, {{0b00'00, 0b01'01, 0b10'10, 0b11'11}});
+	auto [dfa, categories] = chef::minimize(dfa_in,
+		chef::state_categories(16, {{0b00'00, 0b01'01, 0b10'10, 0b11'11}}));
 
 	// Minimized DFA: n0(s) - n1(s) == 0 mod 4. So only 4 states (remainders 0, 1, 2, 3)
 	CHECK(dfa.num_symbols() == 2);
@@ -240,7 +244,7 @@ TEST_CASE("dfa minimization works - sum mod 5 with many symbols")
 	// Num states: 5**4
 	auto const dfa_in = chef::dfa(625, 13, edges);
 
-	auto [dfa, categories] = chef::minimize(dfa_in, {finals});
+	auto [dfa, categories] = chef::minimize(dfa_in, chef::state_categories(625, {finals}));
 
 	// Minimized DFA: we're working mod 5, so only 5 states.
 	CHECK(dfa.num_symbols() == 13);
@@ -272,3 +276,135 @@ TEST_CASE("dfa minimization works - sum mod 5 with many symbols")
 	REQUIRE(categories.size() == 1);
 	CHECK_THAT(::to_vector(categories[0]), IsPermutationOfVector({st3}));
 }
+
+TEST_CASE("dfa minimization agrees with naive partition refinement")
+{
+	std::mt19937 rng(GENERATE(1u, 2u, 3u, 4u, 5u));
+	chef::state_type const num_states = 200;
+	chef::symbol_type const num_symbols = 3;
+
+	std::vector<chef::fa_edge> edges;
+	for (chef::state_type from = 0; from < num_states; ++from) {
+		for (chef::symbol_type on = 0; on < num_symbols; ++on) {
+			edges.push_back({.from = from, .to = chef::state_type(rng() % num_states), .on = on});
+		}
+	}
+	chef::state_categories categories(num_states, 2);
+	for (chef::state_type state = 0; state < num_states; ++state) {
+		if (rng() % 4 == 0) categories.insert(0, state);
+		if (rng() % 8 == 0) categories.insert(1, state);
+	}
+	auto const dfa_in = chef::dfa(num_states, num_symbols, edges);
+
+	// Moore's algorithm, in the most direct way.
+	std::vector<std::size_t> block(num_states);
+	for (chef::state_type state = 0; state < num_states; ++state) {
+		block[state] = categories[0].contains(state) + 2 * categories[1].contains(state);
+	}
+	for (std::size_t num_blocks = 0;;) {
+		std::map<std::vector<std::size_t>, std::size_t> signatures;
+		std::vector<std::size_t> next(num_states);
+		for (chef::state_type state = 0; state < num_states; ++state) {
+			std::vector<std::size_t> signature{block[state]};
+			for (chef::symbol_type on = 0; on < num_symbols; ++on) {
+				signature.push_back(block[dfa_in.process(state, on)]);
+			}
+			next[state] = signatures.emplace(signature, signatures.size()).first->second;
+		}
+		block = next;
+		if (signatures.size() == num_blocks) break;
+		num_blocks = signatures.size();
+	}
+
+	auto const [dfa, new_categories] = chef::minimize(dfa_in, categories);
+
+	// Unreachable states are pruned, so only the reachable states' blocks are left.
+	std::set<std::size_t> reachable_blocks{block[0]};
+	std::vector<chef::state_type> stack{0};
+	std::vector<bool> reached(num_states);
+	reached[0] = true;
+	while (!stack.empty()) {
+		chef::state_type const state = stack.back();
+		stack.pop_back();
+		reachable_blocks.insert(block[state]);
+		for (chef::symbol_type on = 0; on < num_symbols; ++on) {
+			chef::state_type const next = dfa_in.process(state, on);
+			if (!reached[next]) {
+				reached[next] = true;
+				stack.push_back(next);
+			}
+		}
+	}
+	CHECK(dfa.num_states() == reachable_blocks.size());
+	// Minimizing again changes nothing, since the numbering only depends on the partition.
+	auto const [again, again_categories] = chef::minimize(dfa, new_categories);
+	REQUIRE(again.num_states() == dfa.num_states());
+	for (chef::state_type const from : dfa.states()) {
+		for (chef::symbol_type const on : dfa.symbols()) {
+			CHECK(again.process(from, on) == dfa.process(from, on));
+		}
+	}
+	CHECK(again_categories == new_categories);
+}
+
+TEST_CASE("partial dfa minimization agrees with the complete dfa's")
+{
+	std::mt19937 rng(GENERATE(1u, 2u, 3u));
+	chef::state_type const num_states = 100;
+	chef::symbol_type const num_symbols = 3;
+
+	// Some transitions go nowhere in the partial DFA, and to an explicit dead state (the last
+	// state) in the complete one.
+	std::vector<chef::fa_edge> partial_edges;
+	std::vector<chef::fa_edge> complete_edges;
+	for (chef::state_type from = 0; from < num_states; ++from) {
+		for (chef::symbol_type on = 0; on < num_symbols; ++on) {
+			if (rng() % 3 == 0) {
+				complete_edges.push_back({.from = from, .to = num_states, .on = on});
+			} else {
+				chef::fa_edge const edge{
+					.from = from, .to = chef::state_type(rng() % num_states), .on = on};
+				partial_edges.push_back(edge);
+				complete_edges.push_back(edge);
+			}
+		}
+	}
+	for (chef::symbol_type on = 0; on < num_symbols; ++on) {
+		complete_edges.push_back({.from = num_states, .to = num_states, .on = on});
+	}
+	chef::state_categories partial_accepts(num_states, 1);
+	chef::state_categories complete_accepts(num_states + 1, 1);
+	for (chef::state_type state = 0; state < num_states; ++state) {
+		if (rng() % 4 == 0) {
+			partial_accepts.insert(0, state);
+			complete_accepts.insert(0, state);
+		}
+	}
+
+	auto const [partial, partial_categories]
+		= chef::minimize(chef::dfa(num_states, num_symbols, partial_edges), partial_accepts);
+	auto const [complete, complete_categories] = chef::minimize(
+		chef::dfa(num_states + 1, num_symbols, complete_edges), complete_accepts);
+
+	CHECK(partial.is_partial());
+	CHECK(partial.num_states() + 1 == complete.num_states());
+
+	// Walk both together: the dead state is where the complete DFA can no longer accept.
+	std::set<std::pair<chef::state_type, chef::state_type>> seen{{0, 0}};
+	std::vector<std::pair<chef::state_type, chef::state_type>> stack{{0, 0}};
+	std::optional<chef::state_type> complete_dead;
+	while (!stack.empty()) {
+		auto const [lhs, rhs] = stack.back();
+		stack.pop_back();
+		if (lhs == partial.dead_state()) {
+			if (!complete_dead) complete_dead = rhs;
+			CHECK(rhs == *complete_dead);
+			continue;
+		}
+		CHECK(partial_categories[0].contains(lhs) == complete_categories[0].contains(rhs));
+		for (chef::symbol_type const on : partial.symbols()) {
+			std::pair const next{partial.process(lhs, on), complete.process(rhs, on)};
+			if (seen.insert(next).second) stack.push_back(next);
+		}
+	}
+}
@@ -1,18 +1,79 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
+#include <optional>
 #include <span>
 #include <utility>
 #include <vector>
 
+#include <chef/_/memory.hpp>
 #include <chef/_/ranges.hpp>
 #include <chef/dfa/fa.hpp>
 
 namespace chef {
+	namespace detail {
+		// Compressed sparse rows: the targets of row `i` are `targets[offsets[i]..offsets[i + 1])`.
+		class csr_table {
+		private:
+			std::vector<std::size_t> offsets_;
+			std::vector<state_type> targets_;
+
+		public:
+			csr_table() = default;
+
+			// Builds the table from the edges for which `row_of` gives a row.
+			// Within a row, the targets stay in the order of the edge list.
+			template <typename RowOf>
+			explicit csr_table(
+				std::size_t num_rows, std::vector<fa_edge> const& edge_list, RowOf const& row_of)
+				: offsets_(num_rows + 1)
+			{
+				for (auto const edge : edge_list) {
+					if (auto const row = row_of(edge)) ++offsets_[*row + 1];
+				}
+				for (std::size_t row = 0; row < num_rows; ++row) {
+					offsets_[row + 1] += offsets_[row];
+				}
+
+				targets_.resize(offsets_.back());
+				std::vector<std::size_t> fill(offsets_.begin(), offsets_.end() - 1);
+				for (auto const edge : edge_list) {
+					if (auto const row = row_of(edge)) targets_[fill[*row]++] = edge.to;
+				}
+			}
+
+			auto row(std::size_t index) const -> std::span<state_type const>
+			{
+				assert(index + 1 < offsets_.size());
+				return std::span<state_type const>(targets_)
+					.subspan(offsets_[index], offsets_[index + 1] - offsets_[index]);
+			}
+
+			auto memory_usage() const -> std::size_t
+			{
+				return detail::heap_bytes(offsets_) + detail::heap_bytes(targets_);
+			}
+		};
+	}
+
+	// The heap bytes held by a chef::nfa, by component.
+	struct nfa_memory_usage {
+		std::size_t eps_table = 0;
+		std::size_t transition_table = 0;
+
+		auto total() const -> std::size_t
+		{
+			return eps_table + transition_table;
+		}
+	};
+
 	class nfa {
 	private:
-		// A 2d array.
-		std::vector<std::vector<state_type>> transition_table_;
+		// The epsilon transitions, one row per state.
+		detail::csr_table eps_table_;
+		// The other transitions, one row per (state, symbol - 1).
+		detail::csr_table transition_table_;
 		state_type num_states_;
 		symbol_type num_symbols_;
 
@@ -24,11 +85,16 @@ namespace chef {
 			: num_states_(num_states)
 			, num_symbols_(num_symbols)
 		{
-			transition_table_.resize(num_states * num_symbols);
-
-			for (auto const edge : edge_list) {
-				at(edge.from, edge.on).push_back(edge.to);
-			}
+			eps_table_ = detail::csr_table(num_states, edge_list,
+				[](fa_edge const edge) -> std::optional<std::size_t> {
+					if (edge.on != eps) return std::nullopt;
+					return edge.from;
+				});
+			transition_table_ = detail::csr_table(std::size_t(num_states) * num_non_eps_symbols(),
+				edge_list, [this](fa_edge const edge) -> std::optional<std::size_t> {
+					if (edge.on == eps) return std::nullopt;
+					return index(edge.from, edge.on);
+				});
 		}
 
 	public:
@@ -54,23 +120,30 @@ namespace chef {
 
 		auto process(state_type from, symbol_type on) const -> std::span<state_type const>
 		{
-			return at(from, on);
+			assert(from < num_states_);
+			assert(on < num_symbols_);
+			if (on == eps) return eps_table_.row(from);
+			return transition_table_.row(index(from, on));
+		}
+
+		auto memory_usage() const -> chef::nfa_memory_usage
+		{
+			return chef::nfa_memory_usage{
+				.eps_table = eps_table_.memory_usage(),
+				.transition_table = transition_table_.memory_usage(),
+			};
 		}
 
 	private:
-		auto at(state_type from, symbol_type on) const -> std::vector<state_type> const&
+		auto num_non_eps_symbols() const -> std::size_t
 		{
-			assert(from < num_states_);
-			assert(on < num_symbols_);
-			std::size_t const index = num_symbols_ * from + on;
-			assert(index < transition_table_.size());
-
-			return transition_table_[index];
+			return num_symbols_ == 0 ? 0 : num_symbols_ - 1;
 		}
 
-		auto at(state_type from, symbol_type on) -> std::vector<state_type>&
+		auto index(state_type from, symbol_type on) const -> std::size_t
 		{
-			return const_cast<std::vector<state_type>&>(std::as_const(*this).at(from, on));
+			assert(on != eps);
+			return num_non_eps_symbols() * from + (on - 1);
 		}
 	};
 }
@@ -32,3 +32,40 @@ TEST_CASE("nfa works")
 	CHECK_THAT(nfa.process(2, chef::nfa::eps), IsPermutationOfSpan({}));
 	CHECK_THAT(nfa.process(3, chef::nfa::eps), IsPermutationOfSpan({}));
 }
+
+TEST_CASE("nfa keeps epsilon transitions separate")
+{
+	auto nfa = chef::nfa(3, 2,
+		{
+			{.from = 0, .to = 1, .on = chef::nfa::eps},
+			{.from = 0, .to = 2, .on = 1},
+			{.from = 0, .to = 2, .on = chef::nfa::eps},
+			{.from = 2, .to = 0, .on = chef::nfa::eps},
+			{.from = 2, .to = 2, .on = 1},
+		});
+
+	using IsPermutationOfSpan = IsPermutation<std::span<chef::state_type const>>;
+
+	CHECK_THAT(nfa.process(0, chef::nfa::eps), IsPermutationOfSpan({1, 2}));
+	CHECK_THAT(nfa.process(1, chef::nfa::eps), IsPermutationOfSpan({}));
+	CHECK_THAT(nfa.process(2, chef::nfa::eps), IsPermutationOfSpan({0}));
+	CHECK_THAT(nfa.process(0, 1), IsPermutationOfSpan({2}));
+	CHECK_THAT(nfa.process(1, 1), IsPermutationOfSpan({}));
+	CHECK_THAT(nfa.process(2, 1), IsPermutationOfSpan({2}));
+}
+
+TEST_CASE("nfa reports its memory usage")
+{
+	auto nfa = chef::nfa(3, 2,
+		{
+			{.from = 0, .to = 1, .on = chef::nfa::eps},
+			{.from = 0, .to = 2, .on = 1},
+			{.from = 2, .to = 2, .on = 1},
+		});
+
+	auto const usage = nfa.memory_usage();
+	// Offsets for 3 rows, and a target.
+	CHECK(usage.eps_table >= 4 * sizeof(std::size_t) + sizeof(chef::state_type));
+	CHECK(usage.transition_table >= 4 * sizeof(std::size_t) + 2 * sizeof(chef::state_type));
+	CHECK(usage.total() == usage.eps_table + usage.transition_table);
+}
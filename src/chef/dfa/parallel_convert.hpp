@@ -0,0 +1,359 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <chef/_/fwd.hpp>
+#include <chef/_/memory.hpp>
+#include <chef/budget.hpp>
+#include <chef/dfa/categories.hpp>
+#include <chef/dfa/convert.hpp>
+#include <chef/dfa/dfa.hpp>
+#include <chef/dfa/nfa.hpp>
+#include <chef/dfa/prune.hpp>
+#include <chef/dfa/sinks.hpp>
+#include <chef/dfa/stats.hpp>
+
+namespace chef {
+	namespace detail {
+		// A subset of NFA states waiting to be expanded, by its provisional number.
+		struct pending_subset {
+			state_type id;
+			std::vector<state_type> states;
+		};
+
+		// One worker's end of the frontier: the owner works from the back (depth first, which
+		// keeps its working set small) and thieves take from the front.
+		class work_deque {
+		private:
+			std::mutex mutex_;
+			std::deque<pending_subset> items_;
+
+		public:
+			void push(pending_subset item)
+			{
+				std::scoped_lock const lock(mutex_);
+				items_.push_back(CHEF_MOVE(item));
+			}
+
+			auto pop() -> std::optional<pending_subset>
+			{
+				std::scoped_lock const lock(mutex_);
+				if (items_.empty()) return std::nullopt;
+				pending_subset item = CHEF_MOVE(items_.back());
+				items_.pop_back();
+				return item;
+			}
+
+			auto steal() -> std::optional<pending_subset>
+			{
+				std::scoped_lock const lock(mutex_);
+				if (items_.empty()) return std::nullopt;
+				pending_subset item = CHEF_MOVE(items_.front());
+				items_.pop_front();
+				return item;
+			}
+		};
+
+		// A detail::subset_table split into independently locked shards.
+		//
+		// A subset's provisional number is `index_in_shard * num_shards + shard`, which depends
+		// on the order the threads happen to find subsets in.
+		class concurrent_subset_table {
+		public:
+			static constexpr std::size_t num_shards = 64;
+
+		private:
+			struct alignas(64) shard {
+				std::mutex mutex;
+				subset_table subsets;
+			};
+
+			std::array<shard, num_shards> shards_;
+			std::atomic<std::size_t> size_ = 0;
+			std::atomic<std::size_t> memory_bytes_ = 0;
+
+		public:
+			// The subsets added so far.
+			auto size() const -> std::size_t
+			{
+				return size_;
+			}
+
+			// The memory held by the shards so far.
+			auto memory_bytes() const -> std::size_t
+			{
+				return memory_bytes_;
+			}
+
+			// Returns the provisional number of the subset, and whether it was added. If `probes`
+			// is not null, the slots looked at are added to it.
+			auto intern(std::span<state_type const> subset, std::size_t* probes = nullptr)
+				-> std::pair<state_type, bool>
+			{
+				std::uint64_t const hash = detail::hash_states(subset);
+				// The shard takes the high bits, since each subset_table indexes by the low bits.
+				std::size_t const index = hash >> 58;
+				static_assert(num_shards == 1 << (64 - 58));
+
+				auto& shard = shards_[index];
+				std::scoped_lock const lock(shard.mutex);
+				std::size_t const bytes_before = shard.subsets.memory_bytes();
+				auto const [local, inserted] = shard.subsets.intern(subset, hash, probes);
+				if (inserted) {
+					++size_;
+					memory_bytes_ += shard.subsets.memory_bytes() - bytes_before;
+				}
+				return {static_cast<state_type>(local * num_shards + index), inserted};
+			}
+
+			// The dense number of each shard's first subset, and then the number of subsets.
+			// Only call this once the threads are done.
+			auto shard_starts() const -> std::vector<std::size_t>
+			{
+				std::vector<std::size_t> first(num_shards + 1);
+				for (std::size_t index = 0; index < num_shards; ++index) {
+					first[index + 1] = first[index] + shards_[index].subsets.size();
+				}
+				return first;
+			}
+		};
+
+		// What a worker found out about one subset.
+		struct expanded_subsets {
+			std::vector<state_type> ids;
+			// Provisional numbers, one row of num_dfa_symbols per id.
+			std::vector<state_type> rows;
+			// The categories of each id, as rows of a chef::state_categories.
+			std::vector<std::uint64_t> categories;
+			// The slots looked at while interning, if stats are asked for.
+			std::size_t subset_probes = 0;
+		};
+	}
+
+	/**
+	 * \brief Converts the NFA to an equivalent DFA with the powerset construction, on several
+	 * threads
+	 *
+	 * Each thread expands subsets from its own end of a work-stealing frontier, interning the
+	 * successors in a sharded hash table. Threads with nothing to steal block until more work
+	 * is found. The states are then renumbered breadth first, so the result is identical to
+	 * chef::to_dfa()'s whatever the thread count or scheduling.
+	 *
+	 * \param nfa
+	 * \param categories The NFA states of each category (e.g. final states, token types)
+	 * \param num_threads The number of threads to use, including the calling thread
+	 * \param stats If not null, is filled in with the cost of each phase
+	 * \param budget Limits on the DFA's states, the memory used, and the time taken
+	 * \returns The DFA, and the DFA states of each category, with their sinks marked
+	 * \throws chef::construction_budget_error if the conversion goes over the budget
+	 */
+	inline std::pair<chef::dfa, chef::state_categories> parallel_to_dfa(chef::nfa const& nfa,
+		std::vector<std::unordered_set<chef::state_type>> const& categories,
+		std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency()),
+		chef::construction_stats* stats = nullptr, chef::budget const& budget = {})
+	{
+		num_threads = std::max<std::size_t>(num_threads, 1);
+		// Each worker checks its own copy, so they all share the deadline.
+		detail::budget_meter const meter(budget);
+		// As in chef::to_dfa().
+		auto const pruned = chef::prune(nfa, categories);
+		chef::nfa const& pruned_nfa = pruned.first;
+		chef::symbol_type const num_dfa_symbols = pruned_nfa.num_symbols() - 1;
+
+		detail::eps_closures const closures = [&] {
+			detail::phase_timer const timer(stats, &chef::construction_stats::eps_closure_time);
+			return detail::eps_closures(pruned_nfa);
+		}();
+		chef::state_categories const nfa_categories(pruned_nfa.num_states(), pruned.second);
+		std::size_t const row_size = nfa_categories.row_size();
+
+		detail::concurrent_subset_table subsets;
+		std::vector<detail::work_deque> frontier(num_threads);
+		std::vector<detail::expanded_subsets> results(num_threads);
+
+		// Subsets which were found and not yet fully expanded.
+		std::atomic<std::size_t> num_pending = 1;
+		// Changes whenever work is pushed or the threads should stop. Idle workers wait on it
+		// rather than spinning.
+		std::atomic<std::uint64_t> work_epoch = 0;
+		std::atomic<bool> failed = false;
+		std::exception_ptr error;
+		std::mutex error_mutex;
+
+		chef::state_type const start = [&] {
+			auto const initial = closures[0];
+			chef::state_type const id = subsets.intern(initial).first;
+			frontier[0].push(detail::pending_subset{
+				.id = id,
+				.states = std::vector<chef::state_type>(initial.begin(), initial.end()),
+			});
+			return id;
+		}();
+
+		// Checks the subsets so far, and the memory they and their rows take, against the budget.
+		auto const check_size = [&](detail::budget_meter& worker_meter) {
+			std::size_t const size = subsets.size();
+			worker_meter.check_size(
+				size, subsets.memory_bytes() + size * num_dfa_symbols * sizeof(chef::state_type));
+		};
+
+		auto const expand = [&](std::size_t worker, detail::pending_subset const& item,
+			detail::sparse_set& next, detail::budget_meter& worker_meter) {
+			auto& result = results[worker];
+			// Probes are only counted when stats are asked for.
+			std::size_t* const probes = stats ? &result.subset_probes : nullptr;
+
+			check_size(worker_meter);
+			result.ids.push_back(item.id);
+			for (chef::symbol_type symbol = 0; symbol < num_dfa_symbols; ++symbol) {
+				detail::step(pruned_nfa, closures, item.states, symbol + 1, next);
+				auto const [id, inserted] = subsets.intern(next.values(), probes);
+				result.rows.push_back(id);
+				if (inserted) {
+					check_size(worker_meter);
+					++num_pending;
+					frontier[worker].push(detail::pending_subset{
+						.id = id,
+						.states = std::vector<chef::state_type>(
+							next.values().begin(), next.values().end()),
+					});
+					++work_epoch;
+					work_epoch.notify_one();
+				}
+			}
+
+			std::size_t const first_word = result.categories.size();
+			result.categories.resize(first_word + row_size);
+			for (chef::state_type const state : item.states) {
+				auto const row = nfa_categories.row(state);
+				for (std::size_t word = 0; word < row_size; ++word) {
+					result.categories[first_word + word] |= row[word];
+				}
+			}
+		};
+
+		auto const stop_all = [&] {
+			++work_epoch;
+			work_epoch.notify_all();
+		};
+
+		auto const work = [&](std::size_t worker) {
+			try {
+				detail::budget_meter worker_meter = meter;
+				detail::sparse_set next(pruned_nfa.num_states());
+				while (!failed) {
+					// Read before looking for work, so work pushed after the search ends the wait.
+					std::uint64_t const epoch = work_epoch;
+					auto item = frontier[worker].pop();
+					for (std::size_t i = 1; !item && i < num_threads; ++i) {
+						item = frontier[(worker + i) % num_threads].steal();
+					}
+					if (!item) {
+						if (num_pending == 0) return;
+						work_epoch.wait(epoch);
+						continue;
+					}
+
+					expand(worker, *item, next, worker_meter);
+					if (--num_pending == 0) stop_all();
+				}
+			} catch (...) {
+				{
+					std::scoped_lock const lock(error_mutex);
+					if (!error) error = std::current_exception();
+					failed = true;
+				}
+				stop_all();
+			}
+		};
+
+		{
+			detail::phase_timer const timer(stats, &chef::construction_stats::subset_time);
+			std::vector<std::jthread> threads;
+			threads.reserve(num_threads - 1);
+			for (std::size_t worker = 1; worker < num_threads; ++worker) {
+				threads.emplace_back(work, worker);
+			}
+			work(0);
+		}
+		if (error) std::rethrow_exception(error);
+
+		// Gather the rows, numbering the subsets densely (but still arbitrarily) by shard.
+		auto const first_in_shard = subsets.shard_starts();
+		auto const dense = [&](chef::state_type id) {
+			return first_in_shard[id % detail::concurrent_subset_table::num_shards]
+				+ id / detail::concurrent_subset_table::num_shards;
+		};
+		std::size_t const num_subsets = first_in_shard.back();
+
+		std::vector<chef::state_type> rows(num_subsets * num_dfa_symbols);
+		for (auto const& result : results) {
+			for (std::size_t i = 0; i < result.ids.size(); ++i) {
+				std::size_t const from = dense(result.ids[i]);
+				for (chef::symbol_type symbol = 0; symbol < num_dfa_symbols; ++symbol) {
+					rows[from * num_dfa_symbols + symbol] = static_cast<chef::state_type>(
+						dense(result.rows[i * num_dfa_symbols + symbol]));
+				}
+			}
+		}
+
+		// Renumber breadth first, as chef::to_dfa() numbers its states.
+		constexpr auto unnumbered = chef::state_type(-1);
+		std::vector<chef::state_type> numbers(num_subsets, unnumbered);
+		std::vector<std::size_t> order;
+		order.reserve(num_subsets);
+		numbers[dense(start)] = 0;
+		order.push_back(dense(start));
+
+		std::vector<chef::state_type> table;
+		table.reserve(num_subsets * num_dfa_symbols);
+		for (std::size_t i = 0; i < order.size(); ++i) {
+			std::size_t const from = order[i];
+			for (chef::symbol_type symbol = 0; symbol < num_dfa_symbols; ++symbol) {
+				std::size_t const to = rows[from * num_dfa_symbols + symbol];
+				if (numbers[to] == unnumbered) {
+					numbers[to] = static_cast<chef::state_type>(order.size());
+					order.push_back(to);
+				}
+				table.push_back(numbers[to]);
+			}
+		}
+
+		chef::state_categories dfa_categories(
+			static_cast<chef::state_type>(num_subsets), categories.size());
+		for (auto const& result : results) {
+			for (std::size_t i = 0; i < result.ids.size(); ++i) {
+				dfa_categories.insert_all(numbers[dense(result.ids[i])],
+					std::span(result.categories).subspan(i * row_size, row_size));
+			}
+		}
+
+		if (stats) {
+			stats->nfa_states = nfa.num_states();
+			stats->dfa_states = num_subsets;
+			stats->closures += pruned_nfa.num_states();
+			for (auto const& result : results) {
+				stats->subset_probes += result.subset_probes;
+			}
+			stats->note_bytes(closures.memory_bytes() + subsets.memory_bytes()
+				+ detail::heap_bytes(rows) + detail::heap_bytes(table));
+		}
+
+		chef::dfa dfa(static_cast<chef::state_type>(num_subsets), num_dfa_symbols, table);
+		chef::mark_sinks(dfa, dfa_categories);
+		return std::pair{CHEF_MOVE(dfa), CHEF_MOVE(dfa_categories)};
+	}
+}
@@ -0,0 +1,88 @@
+#include <chef/dfa/parallel_convert.hpp>
+
+#include <optional>
+#include <stop_token>
+#include <string>
+
+#include <chef/errors.hpp>
+#include <chef/re/parse.hpp>
+#include <chef/re/to_nfa.hpp>
+
+#include <catch2/catch.hpp>
+
+namespace {
+	using conversion_result = std::pair<chef::dfa, chef::state_categories>;
+
+	void check_same(conversion_result const& lhs, conversion_result const& rhs)
+	{
+		REQUIRE(lhs.first.num_states() == rhs.first.num_states());
+		REQUIRE(lhs.first.num_symbols() == rhs.first.num_symbols());
+		for (chef::state_type const from : lhs.first.states()) {
+			for (chef::symbol_type const on : lhs.first.symbols()) {
+				REQUIRE(lhs.first.process(from, on) == rhs.first.process(from, on));
+			}
+		}
+		CHECK(lhs.second == rhs.second);
+	}
+}
+
+TEST_CASE("Parallel nfa -> dfa conversion numbers states like the serial conversion")
+{
+	std::vector<chef::re> const res{
+		chef::parse_re("(a|b|c)*abc(a|b)(a|c)(b|c)"),
+		chef::parse_re("(ab|ba)*"),
+		chef::parse_re("c(a|b|c)*c"),
+	};
+	auto const [nfa, categories, symbol_map] = chef::to_nfa(res);
+	auto const serial = chef::to_dfa(nfa, categories);
+
+	std::size_t const num_threads = GENERATE(1, 2, 4, 7);
+	check_same(chef::parallel_to_dfa(nfa, categories, num_threads), serial);
+}
+
+TEST_CASE("Parallel nfa -> dfa conversion handles many subsets")
+{
+	// (a|b)*a(a|b)^12, which has 2^13 DFA states.
+	std::string pattern = "(a|b)*a";
+	for (int i = 0; i < 12; ++i) {
+		pattern += "(a|b)";
+	}
+	auto const [nfa, accepts, symbol_map] = chef::to_nfa(chef::parse_re(pattern));
+	auto const serial = chef::to_dfa(nfa, {accepts});
+	auto const parallel = chef::parallel_to_dfa(nfa, {accepts}, 4);
+
+	CHECK(parallel.first.num_states() >= 1u << 13);
+	check_same(parallel, serial);
+}
+
+TEST_CASE("Parallel nfa -> dfa conversion fills in stats and stops at its budget")
+{
+	// (a|b)*a(a|b)^11, which has 2^12 DFA states.
+	std::string pattern = "(a|b)*a";
+	for (int i = 0; i < 11; ++i) {
+		pattern += "(a|b)";
+	}
+	auto const [nfa, accepts, symbol_map] = chef::to_nfa(chef::parse_re(pattern));
+
+	chef::construction_stats stats;
+	auto const [dfa, categories] = chef::parallel_to_dfa(nfa, {accepts}, 4, &stats);
+	CHECK(stats.dfa_states == dfa.num_states());
+	CHECK(stats.closures > 0);
+	CHECK(stats.subset_probes >= dfa.num_states());
+	CHECK(stats.peak_bytes > 0);
+
+	auto const limit = [&](chef::budget const& budget) {
+		try {
+			chef::parallel_to_dfa(nfa, {accepts}, 4, nullptr, budget);
+		} catch (chef::construction_budget_error const& e) {
+			return std::optional(e.limit());
+		}
+		return std::optional<chef::budget_limit>();
+	};
+	CHECK(limit({.max_states = 100}) == chef::budget_limit::states);
+	CHECK(limit({.max_bytes = 4096}) == chef::budget_limit::bytes);
+	std::stop_source stop;
+	stop.request_stop();
+	CHECK(limit({.stop = stop.get_token()}) == chef::budget_limit::cancelled);
+	CHECK(limit({.max_states = dfa.num_states()}) == std::nullopt);
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <barrier>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <chef/_/fwd.hpp>
+#include <chef/_/memory.hpp>
+#include <chef/dfa/categories.hpp>
+#include <chef/dfa/dfa.hpp>
+#include <chef/dfa/minimize.hpp>
+#include <chef/dfa/prune.hpp>
+#include <chef/dfa/stats.hpp>
+
+namespace chef {
+	namespace detail {
+		// Runs `f(thread)` for each thread in [0, num_threads), using the calling thread as
+		// thread 0.
+		template <typename F>
+		void on_threads(std::size_t num_threads, F const& f)
+		{
+			std::vector<std::jthread> threads;
+			threads.reserve(num_threads - 1);
+			for (std::size_t thread = 1; thread < num_threads; ++thread) {
+				threads.emplace_back(f, thread);
+			}
+			f(0);
+		}
+
+		// The number of blocks numbered by detail::number_blocks(), including a partial DFA's
+		// dead state's block, which number_blocks() leaves out of the count.
+		inline auto count_with_dead(chef::dfa const& dfa, std::vector<state_type> const& numbers,
+			state_type num_blocks) -> state_type
+		{
+			bool const separate_dead = dfa.is_partial() && numbers[dfa.dead_state()] == num_blocks;
+			return num_blocks + separate_dead;
+		}
+
+		// The states of [0, num_states) that thread `thread` of `num_threads` works on.
+		inline auto thread_states(
+			state_type num_states, std::size_t num_threads, std::size_t thread)
+			-> std::pair<state_type, state_type>
+		{
+			return {
+				static_cast<state_type>(num_states * thread / num_threads),
+				static_cast<state_type>(num_states * (thread + 1) / num_threads),
+			};
+		}
+	}
+
+	/**
+	 * \brief Minimizes the DFA like chef::minimize(), on several threads
+	 *
+	 * Runs Moore's algorithm: each round, every state's signature (its block and the blocks of
+	 * its successors) is computed in parallel, then the signatures are grouped into the next
+	 * round's blocks in parallel through a hash table sharded by thread, until no block splits.
+	 * Blocks are numbered by their lowest state every round, so the result is identical to
+	 * chef::minimize()'s.
+	 *
+	 * Each round is O(n k) work split across the threads. The threads are started once and
+	 * wait for each other at a std::barrier between the phases of each round. On long chains of
+	 * states the number of rounds approaches the number of states, where chef::minimize() is
+	 * the better choice.
+	 *
+	 * \param dfa
+	 * \param categories Predefined categories that distinguish states (e.g. final vs. non-final)
+	 * \param num_threads The number of threads to use, including the calling thread
+	 * \param stats If not null, is filled in with the cost of minimizing
+	 */
+	inline std::pair<chef::dfa, chef::state_categories> parallel_minimize(chef::dfa const& dfa,
+		chef::state_categories const& categories,
+		std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency()),
+		chef::construction_stats* stats = nullptr)
+	{
+		detail::phase_timer const timer(stats, &chef::construction_stats::minimize_time);
+		num_threads = std::max<std::size_t>(num_threads, 1);
+		// As in chef::minimize().
+		auto const pruned = chef::prune(dfa, categories,
+			dfa.is_partial() ? chef::dfa_kind::partial : chef::dfa_kind::complete);
+		chef::dfa const& pruned_dfa = pruned.first;
+		// Including a partial DFA's dead state, as in chef::minimize().
+		chef::state_type const num_states = detail::num_states_with_dead(pruned_dfa);
+
+		// The first round's blocks: the states with the same categories.
+		std::vector<chef::state_type> blocks;
+		chef::state_type num_blocks;
+		{
+			detail::refinable_partition partition(num_states);
+			detail::partition_by_categories(partition, pruned.second);
+			std::vector<std::size_t> block_of(num_states);
+			for (chef::state_type state = 0; state < num_states; ++state) {
+				block_of[state] = partition.block_of(state);
+			}
+			std::tie(blocks, num_blocks) = detail::number_blocks(pruned_dfa, block_of);
+		}
+
+		auto const same_signature = [&](chef::state_type lhs, chef::state_type rhs) {
+			if (blocks[lhs] != blocks[rhs]) return false;
+			return std::ranges::all_of(pruned_dfa.symbols(), [&](chef::symbol_type const on) {
+				return blocks[detail::successor(pruned_dfa, lhs, on)]
+					== blocks[detail::successor(pruned_dfa, rhs, on)];
+			});
+		};
+
+		std::vector<std::uint64_t> hashes(num_states);
+		std::vector<std::size_t> next_blocks(num_states);
+		// buckets[thread][shard]: the states of the thread's range whose hash is in the shard.
+		std::vector<std::vector<std::vector<chef::state_type>>> buckets(
+			num_threads, std::vector<std::vector<chef::state_type>>(num_threads));
+		std::vector<std::size_t> shard_sizes(num_threads);
+
+		auto const shard_of = [&](chef::state_type state) {
+			return static_cast<std::size_t>((hashes[state] >> 32) % num_threads);
+		};
+
+		std::vector<std::size_t> shard_starts(num_threads);
+		bool done = false;
+
+		// Runs on the last thread to finish each phase of a round, before any thread goes on.
+		std::size_t phase = 0;
+		auto const between_phases = [&]() noexcept {
+			switch (phase++ % 3) {
+			case 0: break;
+			case 1:
+				// Each shard's groups are numbered after those of the shards before it.
+				for (std::size_t shard = 1; shard < num_threads; ++shard) {
+					shard_starts[shard] = shard_starts[shard - 1] + shard_sizes[shard - 1];
+				}
+				break;
+			case 2: {
+				// Blocks only ever split, so the same number of blocks means nothing changed. The
+				// dead state's block must be counted too: splitting it from state 0's block does
+				// not change num_blocks.
+				auto [next, num_next_blocks] = detail::number_blocks(pruned_dfa, next_blocks);
+				chef::state_type const count
+					= detail::count_with_dead(pruned_dfa, blocks, num_blocks);
+				chef::state_type const next_count
+					= detail::count_with_dead(pruned_dfa, next, num_next_blocks);
+				done = next_count == count;
+				if (stats) stats->refinement_splits += next_count - count;
+				if (!done) {
+					blocks = CHEF_MOVE(next);
+					num_blocks = num_next_blocks;
+				}
+				break;
+			}
+			}
+		};
+		std::barrier sync(static_cast<std::ptrdiff_t>(num_threads), between_phases);
+
+		// The threads are started once, and wait for each other between the phases of a round.
+		detail::on_threads(num_threads, [&](std::size_t const thread) {
+			auto const [first, last] = detail::thread_states(num_states, num_threads, thread);
+			while (true) {
+				// Hash each state's signature, and bucket the states by shard.
+				for (auto& bucket : buckets[thread]) {
+					bucket.clear();
+				}
+				for (chef::state_type state = first; state < last; ++state) {
+					std::uint64_t hash = 0xcbf29ce484222325 ^ blocks[state];
+					for (chef::symbol_type const on : pruned_dfa.symbols()) {
+						chef::state_type const next = detail::successor(pruned_dfa, state, on);
+						hash = (hash ^ blocks[next]) * 0x100000001b3;
+					}
+					hash ^= hash >> 29;
+					hashes[state] = hash;
+					buckets[thread][shard_of(state)].push_back(state);
+				}
+				sync.arrive_and_wait();
+
+				// Group each shard's states by signature, numbering the groups within the shard.
+				{
+					std::size_t const shard = thread;
+					auto const hash = [&](chef::state_type state) { return hashes[state]; };
+					std::unordered_map<chef::state_type, std::size_t, decltype(hash),
+						decltype(same_signature)>
+						groups(0, hash, same_signature);
+
+					for (std::size_t from = 0; from < num_threads; ++from) {
+						for (chef::state_type const state : buckets[from][shard]) {
+							next_blocks[state] = groups.emplace(state, groups.size()).first->second;
+						}
+					}
+					shard_sizes[shard] = groups.size();
+				}
+				sync.arrive_and_wait();
+
+				for (chef::state_type state = first; state < last; ++state) {
+					next_blocks[state] += shard_starts[shard_of(state)];
+				}
+				sync.arrive_and_wait();
+
+				if (done) return;
+			}
+		});
+
+		if (stats) {
+			stats->minimized_states = num_blocks;
+			stats->note_bytes(detail::heap_bytes(blocks) + detail::heap_bytes(hashes)
+				+ detail::heap_bytes(next_blocks));
+		}
+
+		return detail::quotient(pruned_dfa, pruned.second, blocks, num_blocks);
+	}
+}
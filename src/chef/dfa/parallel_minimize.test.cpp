@@ -0,0 +1,120 @@
+#include <chef/dfa/parallel_minimize.hpp>
+
+#include <random>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("Parallel dfa minimization gives the same result as chef::minimize")
+{
+	std::mt19937 rng(GENERATE(1u, 2u, 3u));
+	// A random DFA, and a copy of it on states [num_states, 2 * num_states), so that every
+	// state has at least one twin to merge with.
+	chef::state_type const num_states = 300;
+	chef::symbol_type const num_symbols = 4;
+
+	std::vector<chef::fa_edge> edges;
+	for (chef::state_type from = 0; from < num_states; ++from) {
+		for (chef::symbol_type on = 0; on < num_symbols; ++on) {
+			auto const to = chef::state_type(rng() % num_states);
+			auto const target = chef::state_type(to + num_states * (rng() % 2));
+			edges.push_back({.from = from, .to = target, .on = on});
+			edges.push_back({.from = from + num_states, .to = to, .on = on});
+		}
+	}
+	chef::state_categories categories(2 * num_states, 2);
+	for (chef::state_type state = 0; state < num_states; ++state) {
+		for (std::size_t category = 0; category < 2; ++category) {
+			if (rng() % (category == 0 ? 3 : 5) == 0) {
+				categories.insert(category, state);
+				categories.insert(category, state + num_states);
+			}
+		}
+	}
+	auto const dfa_in = chef::dfa(2 * num_states, num_symbols, edges);
+
+	auto const [serial, serial_categories] = chef::minimize(dfa_in, categories);
+	std::size_t const num_threads = GENERATE(1, 2, 3, 8);
+	chef::construction_stats stats;
+	auto const [dfa, dfa_categories]
+		= chef::parallel_minimize(dfa_in, categories, num_threads, &stats);
+
+	CHECK(serial.num_states() <= num_states);
+	CHECK(stats.minimized_states == dfa.num_states());
+	CHECK(stats.peak_bytes > 0);
+	REQUIRE(dfa.num_states() == serial.num_states());
+	for (chef::state_type const from : dfa.states()) {
+		for (chef::symbol_type const on : dfa.symbols()) {
+			REQUIRE(dfa.process(from, on) == serial.process(from, on));
+		}
+	}
+	CHECK(dfa_categories == serial_categories);
+}
+
+namespace {
+	// Checks that parallel_minimize() gives exactly what chef::minimize() does.
+	void check_same(chef::dfa const& dfa_in, chef::state_categories const& categories,
+		std::size_t num_threads)
+	{
+		auto const [serial, serial_categories] = chef::minimize(dfa_in, categories);
+		auto const [dfa, dfa_categories] = chef::parallel_minimize(dfa_in, categories, num_threads);
+
+		CHECK(dfa.is_partial() == serial.is_partial());
+		REQUIRE(dfa.num_states() == serial.num_states());
+		for (chef::state_type const from : dfa.states()) {
+			for (chef::symbol_type const on : dfa.symbols()) {
+				REQUIRE(dfa.process(from, on) == serial.process(from, on));
+			}
+		}
+		CHECK(dfa_categories == serial_categories);
+	}
+}
+
+TEST_CASE("Parallel dfa minimization of partial dfas gives the same result as chef::minimize")
+{
+	std::size_t const num_threads = GENERATE(1, 2, 3, 8);
+
+	SECTION("ab")
+	{
+		// Splitting the start state from the dead state's block leaves the number of blocks
+		// the same.
+		auto const dfa_in = chef::dfa(3, 2,
+			{
+				{.from = 0, .to = 1, .on = 0},
+				{.from = 1, .to = 2, .on = 1},
+			});
+		chef::state_categories categories(3, 1);
+		categories.insert(0, 2);
+
+		check_same(dfa_in, categories, num_threads);
+
+		auto const [dfa, dfa_categories] = chef::parallel_minimize(dfa_in, categories, num_threads);
+		REQUIRE(dfa.num_states() == 3);
+		CHECK(dfa.process(0, 1) == dfa.dead_state());
+		CHECK(dfa.process(1, 0) == dfa.dead_state());
+		CHECK(dfa_categories[0].contains(dfa.process(dfa.process(0, 0), 1)));
+	}
+
+	SECTION("random")
+	{
+		std::mt19937 rng(GENERATE(1u, 2u, 3u));
+		chef::state_type const num_states = 200;
+		chef::symbol_type const num_symbols = 3;
+
+		std::vector<chef::fa_edge> edges;
+		for (chef::state_type from = 0; from < num_states; ++from) {
+			for (chef::symbol_type on = 0; on < num_symbols; ++on) {
+				if (rng() % 3 == 0) continue;
+				edges.push_back(
+					{.from = from, .to = chef::state_type(rng() % num_states), .on = on});
+			}
+		}
+		chef::state_categories categories(num_states, 1);
+		for (chef::state_type state = 0; state < num_states; ++state) {
+			if (rng() % 4 == 0) categories.insert(0, state);
+		}
+		auto const dfa_in = chef::dfa(num_states, num_symbols, edges);
+		REQUIRE(dfa_in.is_partial());
+
+		check_same(dfa_in, categories, num_threads);
+	}
+}
@@ -25,6 +25,7 @@ namespace chef {
 
 			for (auto symbol : dfa.symbols()) {
 				auto next = dfa.process(state, symbol);
+				if (next == dfa.dead_state()) continue;
 				out << std::uint64_t(state) << " --> " << std::uint64_t(next) << " : "
 					<< std::uint64_t(symbol) << '\n';
 			}
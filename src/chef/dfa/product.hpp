@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <chef/_/fwd.hpp>
+#include <chef/_/memory.hpp>
+#include <chef/budget.hpp>
+#include <chef/dfa/categories.hpp>
+#include <chef/dfa/dfa.hpp>
+#include <chef/dfa/minimize.hpp>
+#include <chef/dfa/prune.hpp>
+
+namespace chef {
+	namespace detail {
+		// Prunes and minimizes a DFA with a single category of accepting states.
+		inline auto minimize_accepts(chef::dfa const& dfa,
+			std::vector<chef::state_type> const& accepts)
+			-> std::pair<chef::dfa, chef::state_categories>
+		{
+			chef::state_categories categories(dfa.num_states(), 1);
+			for (chef::state_type const state : accepts) {
+				categories.insert(0, state);
+			}
+			auto const [pruned, pruned_categories] = chef::prune(dfa, categories);
+			return chef::minimize(pruned, pruned_categories);
+		}
+
+		// Builds the reachable part of the product of the DFAs, where a pair of states accepts if
+		// `accept(lhs accepts, rhs accepts)`. Either side of a pair may be its DFA's dead state.
+		// The pairs found are counted against the meter.
+		template <typename Accept>
+		auto product(chef::dfa const& lhs, chef::category_view lhs_accepts,
+			chef::dfa const& rhs, chef::category_view rhs_accepts, Accept const& accept,
+			detail::budget_meter& meter) -> std::pair<chef::dfa, chef::state_categories>
+		{
+			assert(lhs.num_symbols() == rhs.num_symbols());
+			assert(lhs.num_states() != 0 && rhs.num_states() != 0);
+
+			auto const key = [](chef::state_type lhs_state, chef::state_type rhs_state) {
+				return std::uint64_t(lhs_state) << 32 | rhs_state;
+			};
+
+			// The pairs are numbered breadth first from the pair of start states.
+			std::vector<std::pair<chef::state_type, chef::state_type>> pairs{{0, 0}};
+			std::unordered_map<std::uint64_t, chef::state_type> numbers{{key(0, 0), 0}};
+			std::vector<chef::state_type> table;
+			std::vector<chef::state_type> accepts;
+
+			for (chef::state_type cur = 0; cur < pairs.size(); ++cur) {
+				std::size_t const bytes = detail::heap_bytes(pairs) + detail::heap_bytes(numbers)
+					+ detail::heap_bytes(table);
+				meter.check_size(pairs.size(), bytes);
+				auto const [lhs_state, rhs_state] = pairs[cur];
+				if (accept(lhs_accepts.contains(lhs_state), rhs_accepts.contains(rhs_state))) {
+					accepts.push_back(cur);
+				}
+
+				for (chef::symbol_type const on : lhs.symbols()) {
+					chef::state_type const lhs_next = detail::successor(lhs, lhs_state, on);
+					chef::state_type const rhs_next = detail::successor(rhs, rhs_state, on);
+					auto const [it, inserted] = numbers.emplace(
+						key(lhs_next, rhs_next), static_cast<chef::state_type>(pairs.size()));
+					if (inserted) pairs.emplace_back(lhs_next, rhs_next);
+					table.push_back(it->second);
+				}
+			}
+
+			return detail::minimize_accepts(
+				chef::dfa(static_cast<chef::state_type>(pairs.size()), lhs.num_symbols(), table),
+				accepts);
+		}
+	}
+
+	// Boolean operations on the languages of DFAs. Each DFA comes with its accepting states, and
+	// the two DFAs of a binary operation must number their symbols the same way. Only the
+	// reachable pairs of states are built, and the result is pruned and minimized (so it is
+	// partial where it can be). The budget limits the pairs built, as with chef::to_dfa(), and
+	// going over it throws a chef::construction_budget_error.
+
+	/**
+	 * \brief Builds a DFA accepting the strings which both DFAs accept
+	 * \returns The DFA, and its accepting states as its one category
+	 */
+	inline auto intersect(chef::dfa const& lhs, chef::category_view lhs_accepts,
+		chef::dfa const& rhs, chef::category_view rhs_accepts, chef::budget const& budget = {})
+		-> std::pair<chef::dfa, chef::state_categories>
+	{
+		detail::budget_meter meter(budget);
+		return detail::product(
+			lhs, lhs_accepts, rhs, rhs_accepts, [](bool l, bool r) { return l && r; }, meter);
+	}
+
+	/**
+	 * \brief Builds a DFA accepting the strings which either DFA accepts
+	 * \returns The DFA, and its accepting states as its one category
+	 */
+	inline auto unite(chef::dfa const& lhs, chef::category_view lhs_accepts,
+		chef::dfa const& rhs, chef::category_view rhs_accepts, chef::budget const& budget = {})
+		-> std::pair<chef::dfa, chef::state_categories>
+	{
+		detail::budget_meter meter(budget);
+		return detail::product(
+			lhs, lhs_accepts, rhs, rhs_accepts, [](bool l, bool r) { return l || r; }, meter);
+	}
+
+	/**
+	 * \brief Builds a DFA accepting the strings which `lhs` accepts and `rhs` does not
+	 * \returns The DFA, and its accepting states as its one category
+	 */
+	inline auto subtract(chef::dfa const& lhs, chef::category_view lhs_accepts,
+		chef::dfa const& rhs, chef::category_view rhs_accepts, chef::budget const& budget = {})
+		-> std::pair<chef::dfa, chef::state_categories>
+	{
+		detail::budget_meter meter(budget);
+		return detail::product(
+			lhs, lhs_accepts, rhs, rhs_accepts, [](bool l, bool r) { return l && !r; }, meter);
+	}
+
+	/**
+	 * \brief Builds a DFA accepting the strings over the DFA's symbols which it does not accept
+	 *
+	 * A partial DFA's dead state becomes a real, accepting state.
+	 *
+	 * \returns The DFA, and its accepting states as its one category
+	 */
+	inline auto complement(chef::dfa const& dfa,
+		chef::category_view accepts)
+		-> std::pair<chef::dfa, chef::state_categories>
+	{
+		chef::state_type const num_states = detail::num_states_with_dead(dfa);
+		std::vector<chef::state_type> table;
+		table.reserve(std::size_t(num_states) * dfa.num_symbols());
+		std::vector<chef::state_type> complement_accepts;
+		for (chef::state_type state = 0; state < num_states; ++state) {
+			if (!accepts.contains(state)) complement_accepts.push_back(state);
+			for (chef::symbol_type const on : dfa.symbols()) {
+				table.push_back(detail::successor(dfa, state, on));
+			}
+		}
+
+		return detail::minimize_accepts(chef::dfa(num_states, dfa.num_symbols(), table),
+			complement_accepts);
+	}
+}
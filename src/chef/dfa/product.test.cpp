@@ -0,0 +1,99 @@
+#include <chef/dfa/product.hpp>
+
+#include <string_view>
+
+#include <catch2/catch.hpp>
+
+namespace {
+	// Over the symbols a = 0, b = 1.
+	bool accepts(std::pair<chef::dfa, chef::state_categories> const& result,
+		std::string_view str)
+	{
+		auto const& [dfa, categories] = result;
+		chef::state_type state = 0;
+		for (char const c : str) {
+			state = dfa.process(state, c == 'a' ? 0 : 1);
+			if (state == dfa.dead_state()) return false;
+		}
+		return categories.contains(0, state);
+	}
+}
+
+TEST_CASE("dfa boolean operations")
+{
+	// An even number of a's.
+	auto const even_a = chef::dfa(2, 2,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 0, .to = 0, .on = 1},
+			{.from = 1, .to = 0, .on = 0},
+			{.from = 1, .to = 1, .on = 1},
+		});
+	auto const even_a_categories = chef::state_categories(2, {{0}});
+	auto const even_a_accepts = even_a_categories[0];
+	// Strings starting with b; partial.
+	auto const starts_b = chef::dfa(2, 2,
+		{
+			{.from = 0, .to = 1, .on = 1},
+			{.from = 1, .to = 1, .on = 0},
+			{.from = 1, .to = 1, .on = 1},
+		});
+	auto const starts_b_categories = chef::state_categories(2, {{1}});
+	auto const starts_b_accepts = starts_b_categories[0];
+
+	SECTION("intersection")
+	{
+		auto const result = chef::intersect(even_a, even_a_accepts, starts_b, starts_b_accepts);
+		CHECK(result.first.num_states() == 3);
+		CHECK(result.first.is_partial());
+		CHECK(accepts(result, "b"));
+		CHECK(accepts(result, "baab"));
+		CHECK_FALSE(accepts(result, "ba"));
+		CHECK_FALSE(accepts(result, "aab"));
+		CHECK_FALSE(accepts(result, ""));
+
+		// The product has more pairs than the budget allows.
+		chef::budget const budget{.max_states = 2};
+		CHECK_THROWS_AS(chef::intersect(even_a, even_a_accepts, starts_b, starts_b_accepts, budget),
+			chef::construction_budget_error);
+	}
+
+	SECTION("union")
+	{
+		auto const result = chef::unite(even_a, even_a_accepts, starts_b, starts_b_accepts);
+		CHECK(accepts(result, ""));
+		CHECK(accepts(result, "aa"));
+		CHECK(accepts(result, "ba"));
+		CHECK_FALSE(accepts(result, "a"));
+		CHECK_FALSE(accepts(result, "ab"));
+	}
+
+	SECTION("difference")
+	{
+		auto const result = chef::subtract(starts_b, starts_b_accepts, even_a, even_a_accepts);
+		CHECK(accepts(result, "ba"));
+		CHECK(accepts(result, "bbaaa"));
+		CHECK_FALSE(accepts(result, "b"));
+		CHECK_FALSE(accepts(result, "a"));
+	}
+
+	SECTION("complement")
+	{
+		auto const result = chef::complement(starts_b, starts_b_accepts);
+		CHECK(result.first.num_states() == 2);
+		// Strings starting with b can no longer be accepted.
+		CHECK(result.first.is_partial());
+		CHECK(accepts(result, ""));
+		CHECK(accepts(result, "ab"));
+		CHECK_FALSE(accepts(result, "b"));
+		CHECK_FALSE(accepts(result, "bab"));
+	}
+
+	SECTION("a language minus itself is empty")
+	{
+		auto const [dfa, categories]
+			= chef::subtract(even_a, even_a_accepts, even_a, even_a_accepts);
+		CHECK(dfa.num_states() == 1);
+		CHECK(categories[0].empty());
+	}
+}
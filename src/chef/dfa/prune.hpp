@@ -0,0 +1,230 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <chef/_/fwd.hpp>
+#include <chef/dfa/categories.hpp>
+#include <chef/dfa/dfa.hpp>
+#include <chef/dfa/fa.hpp>
+#include <chef/dfa/nfa.hpp>
+
+namespace chef {
+	namespace detail {
+		// Marks the states reached from the seeds, where `for_each_next(state, f)` calls `f` with
+		// each state one step from `state`.
+		template <typename ForEachNext>
+		auto reach(state_type num_states, std::vector<state_type> stack,
+			ForEachNext const& for_each_next) -> std::vector<bool>
+		{
+			std::vector<bool> reached(num_states);
+			for (state_type const seed : stack) {
+				reached[seed] = true;
+			}
+
+			while (!stack.empty()) {
+				state_type const cur = stack.back();
+				stack.pop_back();
+				for_each_next(cur, [&](state_type next) {
+					if (!reached[next]) {
+						reached[next] = true;
+						stack.push_back(next);
+					}
+				});
+			}
+			return reached;
+		}
+
+		// Marks the states from which the edges lead to one of the seeds.
+		inline auto co_reachable(state_type num_states, std::vector<fa_edge> const& edges,
+			std::vector<state_type> seeds) -> std::vector<bool>
+		{
+			std::vector<fa_edge> reversed;
+			reversed.reserve(edges.size());
+			for (auto const [from, to, on] : edges) {
+				reversed.push_back({.from = to, .to = from, .on = on});
+			}
+			detail::csr_table const predecessors(num_states, reversed,
+				[](fa_edge const edge) -> std::optional<std::size_t> { return edge.from; });
+
+			return detail::reach(num_states, CHEF_MOVE(seeds), [&](state_type state, auto visit) {
+				for (state_type const prev : predecessors.row(state)) {
+					visit(prev);
+				}
+			});
+		}
+
+		// The new numbers of the states which are kept, in their old order. The start state is
+		// always kept.
+		struct renumbering {
+			static constexpr state_type removed = state_type(-1);
+
+			std::vector<state_type> new_state;
+			state_type num_states = 0;
+
+			explicit renumbering(std::vector<bool> const& keep)
+				: new_state(keep.size(), removed)
+			{
+				for (std::size_t state = 0; state < keep.size(); ++state) {
+					if (state == 0 || keep[state]) new_state[state] = num_states++;
+				}
+			}
+
+			auto categories(std::vector<std::unordered_set<state_type>> const& categories) const
+				-> std::vector<std::unordered_set<state_type>>
+			{
+				std::vector<std::unordered_set<state_type>> result(categories.size());
+				for (std::size_t i = 0; i < categories.size(); ++i) {
+					for (state_type const state : categories[i]) {
+						if (state < new_state.size() && new_state[state] != removed) {
+							result[i].insert(new_state[state]);
+						}
+					}
+				}
+				return result;
+			}
+
+			auto categories(chef::state_categories const& categories) const
+				-> chef::state_categories
+			{
+				chef::state_categories result(num_states, categories.num_categories());
+				for (state_type state = 0; state < categories.num_states(); ++state) {
+					if (new_state[state] != removed) {
+						result.insert_all(new_state[state], categories.row(state));
+					}
+				}
+				return result;
+			}
+		};
+	}
+
+	/**
+	 * \brief Removes the states which can't be reached from the start state or can't reach a
+	 * state of any category
+	 *
+	 * The start state is always kept. The other states keep their relative order. Category
+	 * states which aren't in the NFA are dropped.
+	 *
+	 * \param nfa
+	 * \param categories The NFA states of each category (e.g. final states, token types)
+	 * \returns The pruned NFA, and its states of each category
+	 */
+	inline std::pair<chef::nfa, std::vector<std::unordered_set<chef::state_type>>> prune(
+		chef::nfa const& nfa, std::vector<std::unordered_set<chef::state_type>> const& categories)
+	{
+		if (nfa.num_states() == 0) {
+			using category_sets = std::vector<std::unordered_set<chef::state_type>>;
+			return std::pair{nfa, category_sets(categories.size())};
+		}
+
+		std::vector<chef::fa_edge> edges;
+		for (chef::state_type const from : nfa.states()) {
+			for (chef::symbol_type const on : nfa.symbols()) {
+				for (chef::state_type const to : nfa.process(from, on)) {
+					edges.push_back({.from = from, .to = to, .on = on});
+				}
+			}
+		}
+
+		std::vector<bool> keep = detail::reach(nfa.num_states(), {0}, [&](auto from, auto visit) {
+			for (chef::symbol_type const on : nfa.symbols()) {
+				for (chef::state_type const to : nfa.process(from, on)) {
+					visit(to);
+				}
+			}
+		});
+		std::vector<chef::state_type> seeds;
+		for (auto const& category : categories) {
+			for (chef::state_type const state : category) {
+				if (state < nfa.num_states()) seeds.push_back(state);
+			}
+		}
+		std::vector<bool> const co_reachable
+			= detail::co_reachable(nfa.num_states(), edges, CHEF_MOVE(seeds));
+		for (chef::state_type const state : nfa.states()) {
+			keep[state] = keep[state] && co_reachable[state];
+		}
+
+		detail::renumbering const numbering(keep);
+		std::vector<chef::fa_edge> new_edges;
+		for (auto const [from, to, on] : edges) {
+			chef::state_type const new_from = numbering.new_state[from];
+			chef::state_type const new_to = numbering.new_state[to];
+			if (new_from == numbering.removed || new_to == numbering.removed) continue;
+			new_edges.push_back({.from = new_from, .to = new_to, .on = on});
+		}
+
+		return std::pair{
+			chef::nfa(numbering.num_states, nfa.num_symbols(), new_edges),
+			numbering.categories(categories),
+		};
+	}
+
+	/**
+	 * \brief Removes the states which can't be reached from the start state and, for a partial
+	 * result, the states which can't reach a state of any category
+	 *
+	 * The start state is always kept. The other states keep their relative order.
+	 *
+	 * \param dfa
+	 * \param categories Predefined categories that distinguish states (e.g. final vs. non-final)
+	 * \param kind With chef::dfa_kind::partial, the states which can't reach a category are
+	 * replaced by the implicit chef::dfa::dead_state(); with chef::dfa_kind::complete, only the
+	 * unreachable states are removed.
+	 * \returns The pruned DFA, and its states of each category
+	 */
+	inline std::pair<chef::dfa, chef::state_categories> prune(chef::dfa const& dfa,
+		chef::state_categories const& categories, chef::dfa_kind kind = chef::dfa_kind::partial)
+	{
+		if (dfa.num_states() == 0) return std::pair{dfa, categories};
+
+		std::vector<bool> keep = detail::reach(dfa.num_states(), {0}, [&](auto from, auto visit) {
+			for (chef::symbol_type const on : dfa.symbols()) {
+				chef::state_type const to = dfa.process(from, on);
+				if (to != dfa.dead_state()) visit(to);
+			}
+		});
+
+		if (kind == chef::dfa_kind::partial) {
+			std::vector<chef::fa_edge> edges;
+			for (chef::state_type const from : dfa.states()) {
+				if (!keep[from]) continue;
+				for (chef::symbol_type const on : dfa.symbols()) {
+					chef::state_type const to = dfa.process(from, on);
+					if (to != dfa.dead_state()) edges.push_back({.from = from, .to = to, .on = on});
+				}
+			}
+			std::vector<chef::state_type> seeds;
+			for (chef::state_type const state : dfa.states()) {
+				if (categories.first(state)) seeds.push_back(state);
+			}
+			std::vector<bool> const co_reachable
+				= detail::co_reachable(dfa.num_states(), edges, CHEF_MOVE(seeds));
+			for (chef::state_type const state : dfa.states()) {
+				keep[state] = keep[state] && co_reachable[state];
+			}
+		}
+
+		detail::renumbering const numbering(keep);
+		std::vector<chef::state_type> table;
+		table.reserve(std::size_t(numbering.num_states) * dfa.num_symbols());
+		for (chef::state_type const from : dfa.states()) {
+			if (numbering.new_state[from] == numbering.removed) continue;
+			for (chef::symbol_type const on : dfa.symbols()) {
+				chef::state_type const to = dfa.process(from, on);
+				// Removed states become the new dead state, numbering.num_states.
+				bool const is_dead
+					= to == dfa.dead_state() || numbering.new_state[to] == numbering.removed;
+				table.push_back(is_dead ? numbering.num_states : numbering.new_state[to]);
+			}
+		}
+
+		return std::pair{
+			chef::dfa(numbering.num_states, dfa.num_symbols(), table),
+			numbering.categories(categories),
+		};
+	}
+}
@@ -0,0 +1,110 @@
+#include <chef/dfa/prune.hpp>
+
+#include <ranges>
+
+#include "chef/matchers.test.inl"
+
+#include <catch2/catch.hpp>
+
+using IsPermutationOfVector = IsPermutation<std::vector<chef::state_type>>;
+
+namespace {
+	auto to_vector(std::ranges::range auto&& range)
+	{
+		using range_type = std::remove_cvref_t<decltype(range)>;
+		return std::vector<std::ranges::range_value_t<range_type>>(
+			std::ranges::begin(range), std::ranges::end(range));
+	}
+}
+
+TEST_CASE("nfa pruning removes unreachable and dead-end states")
+{
+	// 0 -a-> 1 -b-> 3 (final); 1 -a-> 2, which goes nowhere; 4 -eps-> 3, unreachable.
+	auto const nfa = chef::nfa(5, 3,
+		{
+			{.from = 0, .to = 1, .on = 1},
+			{.from = 1, .to = 2, .on = 1},
+			{.from = 1, .to = 3, .on = 2},
+			{.from = 3, .to = 3, .on = 1},
+			{.from = 4, .to = 3, .on = 0},
+		});
+
+	auto const [pruned, categories] = chef::prune(nfa, {{3}});
+
+	REQUIRE(pruned.num_states() == 3);
+	CHECK_THAT(::to_vector(pruned.process(0, 1)), IsPermutationOfVector({1}));
+	CHECK(pruned.process(1, 1).empty());
+	CHECK_THAT(::to_vector(pruned.process(1, 2)), IsPermutationOfVector({2}));
+	CHECK_THAT(::to_vector(pruned.process(2, 1)), IsPermutationOfVector({2}));
+	CHECK_THAT(::to_vector(categories[0]), IsPermutationOfVector({2}));
+}
+
+TEST_CASE("nfa pruning keeps the start state")
+{
+	auto const nfa = chef::nfa(2, 2, {{.from = 0, .to = 1, .on = 1}});
+
+	auto const [pruned, categories] = chef::prune(nfa, {{}});
+
+	CHECK(pruned.num_states() == 1);
+	CHECK(pruned.process(0, 1).empty());
+	CHECK(categories[0].empty());
+}
+
+TEST_CASE("nfa pruning drops category states which aren't in the nfa")
+{
+	auto const nfa = chef::nfa(2, 2, {{.from = 0, .to = 1, .on = 1}});
+
+	auto const [pruned, categories] = chef::prune(nfa, {{1, 99}});
+
+	CHECK(pruned.num_states() == 2);
+	CHECK_THAT(::to_vector(categories[0]), IsPermutationOfVector({1}));
+}
+
+TEST_CASE("nfa pruning of an nfa without states")
+{
+	auto const [pruned, categories] = chef::prune(chef::nfa(0, 1, {}), {{0}});
+
+	CHECK(pruned.num_states() == 0);
+	CHECK(categories[0].empty());
+}
+
+TEST_CASE("dfa pruning")
+{
+	// 0 -> 1 (final) -> 1, 0 -> 2 -> 2 (which can't accept), 3 -> 1 (unreachable).
+	auto const dfa = chef::dfa(4, 2,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 0, .to = 2, .on = 1},
+			{.from = 1, .to = 1, .on = 0},
+			{.from = 1, .to = 1, .on = 1},
+			{.from = 2, .to = 2, .on = 0},
+			{.from = 2, .to = 2, .on = 1},
+			{.from = 3, .to = 1, .on = 0},
+			{.from = 3, .to = 1, .on = 1},
+		});
+
+	SECTION("partial: dead ends become the dead state")
+	{
+		auto const [pruned, categories] = chef::prune(dfa, chef::state_categories(4, {{1}}));
+
+		REQUIRE(pruned.num_states() == 2);
+		CHECK(pruned.is_partial());
+		CHECK(pruned.process(0, 0) == 1);
+		CHECK(pruned.process(0, 1) == pruned.dead_state());
+		CHECK(pruned.process(1, 0) == 1);
+		CHECK(pruned.process(1, 1) == 1);
+		CHECK_THAT(::to_vector(categories[0]), IsPermutationOfVector({1}));
+	}
+
+	SECTION("complete: only unreachable states are removed")
+	{
+		auto const [pruned, categories]
+			= chef::prune(dfa, chef::state_categories(4, {{1}}), chef::dfa_kind::complete);
+
+		REQUIRE(pruned.num_states() == 3);
+		CHECK_FALSE(pruned.is_partial());
+		CHECK(pruned.process(0, 1) == 2);
+		CHECK(pruned.process(2, 0) == 2);
+		CHECK_THAT(::to_vector(categories[0]), IsPermutationOfVector({1}));
+	}
+}
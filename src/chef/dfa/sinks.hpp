@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <chef/_/fwd.hpp>
+#include <chef/dfa/categories.hpp>
+#include <chef/dfa/dfa.hpp>
+
+namespace chef {
+	namespace detail {
+		// Marks every state which can reach one of the `seeds` by walking the reversed edges.
+		inline std::vector<bool> reaches_any(chef::dfa const& dfa,
+			std::vector<std::size_t> const& reverse_offsets,
+			std::vector<chef::state_type> const& reverse_targets,
+			std::vector<chef::state_type> queue)
+		{
+			std::vector<bool> reached(dfa.num_states());
+			for (chef::state_type const seed : queue) {
+				reached[seed] = true;
+			}
+
+			while (!queue.empty()) {
+				chef::state_type const cur = queue.back();
+				queue.pop_back();
+
+				for (std::size_t i = reverse_offsets[cur]; i < reverse_offsets[cur + 1]; ++i) {
+					chef::state_type const prev = reverse_targets[i];
+					if (!reached[prev]) {
+						reached[prev] = true;
+						queue.push_back(prev);
+					}
+				}
+			}
+
+			return reached;
+		}
+	}
+
+	/**
+	 * \brief Finds the states from which the remaining input cannot change the match result
+	 *
+	 * A state is a sink if every state reachable from it is in exactly the same categories:
+	 * sink_kind::dead if that is none of them, sink_kind::accept_forever otherwise. With a
+	 * single category, these are the states which can never accept and the states which
+	 * accept whatever follows.
+	 *
+	 * \param dfa
+	 * \param categories The categories of the DFA's states (e.g. final states, token types)
+	 * \returns The sink_kind of each state, indexed by state. A partial DFA's dead_state() is
+	 * not included; it is always sink_kind::dead.
+	 */
+	inline std::vector<chef::sink_kind> find_sinks(
+		chef::dfa const& dfa, chef::state_categories const& categories)
+	{
+		auto const in_any = [&](chef::state_type state) {
+			return state != dfa.dead_state() && categories.first(state).has_value();
+		};
+		auto const same_categories = [&](chef::state_type lhs, chef::state_type rhs) {
+			if (lhs == dfa.dead_state() || rhs == dfa.dead_state()) {
+				return !in_any(lhs) && !in_any(rhs);
+			}
+			return categories.same_categories(lhs, rhs);
+		};
+
+		// Reverse the transitions, as a flat [to] -> [from...] table. A partial DFA's dead state
+		// has no row to reverse; the states which go to it are only seeds below.
+		std::vector<std::size_t> reverse_offsets(dfa.num_states() + 1);
+		// The states with a transition into a state of other categories.
+		std::vector<chef::state_type> changes;
+		for (chef::state_type const from : dfa.states()) {
+			bool changes_categories = false;
+			for (chef::symbol_type const sym : dfa.symbols()) {
+				chef::state_type const to = dfa.process(from, sym);
+				if (to != dfa.dead_state()) ++reverse_offsets[to + 1];
+				changes_categories = changes_categories || !same_categories(from, to);
+			}
+			if (changes_categories) changes.push_back(from);
+		}
+		for (std::size_t i = 1; i < reverse_offsets.size(); ++i) {
+			reverse_offsets[i] += reverse_offsets[i - 1];
+		}
+
+		std::vector<chef::state_type> reverse_targets(reverse_offsets.back());
+		{
+			std::vector<std::size_t> fill(reverse_offsets.begin(), reverse_offsets.end() - 1);
+			for (chef::state_type const from : dfa.states()) {
+				for (chef::symbol_type const sym : dfa.symbols()) {
+					chef::state_type const to = dfa.process(from, sym);
+					if (to != dfa.dead_state()) reverse_targets[fill[to]++] = from;
+				}
+			}
+		}
+
+		// A state is decided unless it can reach a change of categories.
+		std::vector<bool> const can_change
+			= detail::reaches_any(dfa, reverse_offsets, reverse_targets, CHEF_MOVE(changes));
+
+		std::vector<chef::sink_kind> result(dfa.num_states(), chef::sink_kind::none);
+		for (chef::state_type const state : dfa.states()) {
+			if (can_change[state]) continue;
+			result[state] = in_any(state) ? chef::sink_kind::accept_forever : chef::sink_kind::dead;
+		}
+
+		return result;
+	}
+
+	// Marks the sink kind of each state in the categories, as found by chef::find_sinks(). The
+	// DFA constructions do this for the DFAs they build.
+	inline void mark_sinks(chef::dfa const& dfa, chef::state_categories& categories)
+	{
+		categories.set_sinks(chef::find_sinks(dfa, categories));
+	}
+
+	// The sink kind of each state: as marked when the DFA was built, or else found now.
+	inline std::vector<chef::sink_kind> sinks_of(
+		chef::dfa const& dfa, chef::state_categories const& categories)
+	{
+		if (!categories.has_sinks()) return chef::find_sinks(dfa, categories);
+
+		std::vector<chef::sink_kind> result(dfa.num_states());
+		for (chef::state_type const state : dfa.states()) {
+			result[state] = categories.sink(state);
+		}
+		return result;
+	}
+
+	// The sink kind of each state for one category: as marked when the DFA was built, or else
+	// found now.
+	inline std::vector<chef::sink_kind> sinks_of(chef::dfa const& dfa, chef::category_view accepts)
+	{
+		std::vector<chef::sink_kind> result(dfa.num_states());
+		if (accepts.has_sinks()) {
+			for (chef::state_type const state : dfa.states()) {
+				result[state] = accepts.sink(state);
+			}
+			return result;
+		}
+
+		chef::state_categories single(dfa.num_states(), 1);
+		for (chef::state_type const state : accepts) {
+			single.insert(0, state);
+		}
+		return chef::find_sinks(dfa, single);
+	}
+}
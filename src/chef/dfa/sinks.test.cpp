@@ -0,0 +1,87 @@
+#include <chef/dfa/sinks.hpp>
+
+#include <chef/dfa/minimize.hpp>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("dead and accept-forever states are found")
+{
+	// 0 --0--> 1 (accepts, loops on everything)
+	// 0 --1--> 2 (rejects, loops on everything)
+	// 3: accepts, but can fall into 2
+	auto const dfa = chef::dfa(4, 2,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 0, .to = 2, .on = 1},
+			{.from = 1, .to = 1, .on = 0},
+			{.from = 1, .to = 1, .on = 1},
+			{.from = 2, .to = 2, .on = 0},
+			{.from = 2, .to = 2, .on = 1},
+			{.from = 3, .to = 1, .on = 0},
+			{.from = 3, .to = 2, .on = 1},
+		});
+
+	auto const sinks = chef::find_sinks(dfa, chef::state_categories(4, {{1, 3}}));
+
+	REQUIRE(sinks.size() == 4);
+	CHECK(sinks[0] == chef::sink_kind::none);
+	CHECK(sinks[1] == chef::sink_kind::accept_forever);
+	CHECK(sinks[2] == chef::sink_kind::dead);
+	CHECK(sinks[3] == chef::sink_kind::none);
+}
+
+TEST_CASE("a DFA without accepting states is all dead")
+{
+	auto const dfa = chef::dfa(2, 1,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 1, .to = 0, .on = 0},
+		});
+
+	auto const sinks = chef::find_sinks(dfa, chef::state_categories(2, 1));
+
+	CHECK(sinks[0] == chef::sink_kind::dead);
+	CHECK(sinks[1] == chef::sink_kind::dead);
+}
+
+TEST_CASE("a state is only a sink if its categories can't change")
+{
+	// 0 --0--> 1 (category 0) --0--> 2 (categories 0 and 1, loops)
+	auto const dfa = chef::dfa(3, 1,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 1, .to = 2, .on = 0},
+			{.from = 2, .to = 2, .on = 0},
+		});
+	chef::state_categories const categories(3, {{1, 2}, {2}});
+
+	auto const sinks = chef::find_sinks(dfa, categories);
+
+	CHECK(sinks[0] == chef::sink_kind::none);
+	CHECK(sinks[1] == chef::sink_kind::none);
+	CHECK(sinks[2] == chef::sink_kind::accept_forever);
+}
+
+TEST_CASE("minimize marks the sinks of its result")
+{
+	// 0 --0--> 1 (accepts, loops); 0 --1--> dead
+	auto const dfa = chef::dfa(2, 2,
+		{
+			{.from = 0, .to = 1, .on = 0},
+			{.from = 1, .to = 1, .on = 0},
+			{.from = 1, .to = 1, .on = 1},
+		});
+
+	chef::state_categories const unmarked(2, {{1}});
+	CHECK_FALSE(unmarked.has_sinks());
+	CHECK(unmarked[0].sink(1) == chef::sink_kind::none);
+
+	auto const [min_dfa, categories] = chef::minimize(dfa, unmarked);
+
+	REQUIRE(categories.has_sinks());
+	CHECK(categories.sink(0) == chef::sink_kind::none);
+	CHECK(categories.sink(1) == chef::sink_kind::accept_forever);
+	CHECK(categories.sink(min_dfa.dead_state()) == chef::sink_kind::dead);
+	CHECK(categories[0].sink(1) == chef::sink_kind::accept_forever);
+	CHECK(chef::sinks_of(min_dfa, categories[0]) == chef::find_sinks(min_dfa, categories));
+}
@@ -0,0 +1,29 @@
+#include "./stats.hpp"
+
+#include <ostream>
+
+namespace chef {
+	namespace {
+		auto write_time(std::ostream& out, char const* phase, std::chrono::nanoseconds time)
+			-> std::ostream&
+		{
+			return out << phase << ": "
+					   << std::chrono::duration<double, std::milli>(time).count() << " ms\n";
+		}
+	}
+
+	auto operator<<(std::ostream& out, construction_stats const& stats) -> std::ostream&
+	{
+		write_time(out, "to_nfa", stats.to_nfa_time);
+		write_time(out, "eps_closure", stats.eps_closure_time);
+		write_time(out, "subsets", stats.subset_time);
+		write_time(out, "minimize", stats.minimize_time);
+		return out << "nfa states: " << stats.nfa_states << '\n'
+				   << "dfa states: " << stats.dfa_states << '\n'
+				   << "minimized states: " << stats.minimized_states << '\n'
+				   << "closures: " << stats.closures << '\n'
+				   << "subset probes: " << stats.subset_probes << '\n'
+				   << "refinement splits: " << stats.refinement_splits << '\n'
+				   << "peak bytes: " << stats.peak_bytes << '\n';
+	}
+}
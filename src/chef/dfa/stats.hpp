@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
+
+namespace chef {
+	// What the construction of an automaton cost, phase by phase. Pass a pointer to one to
+	// chef::to_nfa(), chef::to_dfa(), chef::parallel_to_dfa(), chef::minimize() or
+	// chef::parallel_minimize() to have it filled in; with the default null pointer, nothing is
+	// measured.
+	//
+	// Times and counters add up over calls, so one object can cover a whole pipeline. Sizes
+	// are of the last automaton built in each phase.
+	struct construction_stats {
+		// Wall time of each phase.
+		std::chrono::nanoseconds to_nfa_time{};
+		std::chrono::nanoseconds eps_closure_time{};
+		std::chrono::nanoseconds subset_time{};
+		std::chrono::nanoseconds minimize_time{};
+
+		std::size_t nfa_states = 0;
+		std::size_t dfa_states = 0;
+		std::size_t minimized_states = 0;
+
+		// The epsilon closures computed, one per NFA state.
+		std::size_t closures = 0;
+		// The slots looked at while interning subsets of NFA states.
+		std::size_t subset_probes = 0;
+		// The blocks split off during partition refinement.
+		std::size_t refinement_splits = 0;
+
+		// The most memory held at once by a phase's working data, in bytes.
+		std::size_t peak_bytes = 0;
+
+		void note_bytes(std::size_t bytes)
+		{
+			peak_bytes = std::max(peak_bytes, bytes);
+		}
+
+		// Writes one line per phase and counter, for people.
+		friend auto operator<<(std::ostream& out, construction_stats const& stats)
+			-> std::ostream&;
+	};
+
+	namespace detail {
+		// Adds the time from construction to destruction to one phase of the stats, if any.
+		class phase_timer {
+		private:
+			std::chrono::nanoseconds* time_;
+			std::chrono::steady_clock::time_point start_;
+
+		public:
+			explicit phase_timer(
+				construction_stats* stats, std::chrono::nanoseconds construction_stats::*phase)
+				: time_(stats ? &(stats->*phase) : nullptr)
+			{
+				if (time_) start_ = std::chrono::steady_clock::now();
+			}
+
+			phase_timer(phase_timer const&) = delete;
+			auto operator=(phase_timer const&) -> phase_timer& = delete;
+
+			~phase_timer()
+			{
+				if (time_) *time_ += std::chrono::steady_clock::now() - start_;
+			}
+		};
+	}
+}
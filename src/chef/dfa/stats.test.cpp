@@ -0,0 +1,46 @@
+#include <chef/dfa/stats.hpp>
+
+#include <sstream>
+
+#include <chef/dfa/convert.hpp>
+#include <chef/dfa/minimize.hpp>
+#include <chef/re/parse.hpp>
+#include <chef/re/to_nfa.hpp>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("construction stats are filled in by each phase")
+{
+	chef::construction_stats stats;
+	auto const nfa_result = chef::to_nfa(chef::parse_re("(a|b)*abb(a|b)*"), &stats);
+	CHECK(stats.nfa_states == nfa_result.nfa.num_states());
+
+	auto const [dfa, categories] = chef::to_dfa(
+		nfa_result.nfa, {nfa_result.accepts}, chef::dfa_kind::complete, &stats);
+	CHECK(stats.dfa_states == dfa.num_states());
+	CHECK(stats.closures > 0);
+	// Every subset is looked up at least once.
+	CHECK(stats.subset_probes >= dfa.num_states());
+
+	auto const [minimal, minimal_categories] = chef::minimize(dfa, categories, &stats);
+	CHECK(stats.minimized_states == minimal.num_states());
+	// From {accepting, not accepting} to the minimal DFA's states.
+	CHECK(stats.refinement_splits == minimal.num_states() - 2);
+	CHECK(stats.peak_bytes > 0);
+
+	std::ostringstream out;
+	out << stats;
+	CHECK_THAT(out.str(), Catch::Contains("minimized states: 4\n"));
+	CHECK_THAT(out.str(), Catch::Contains("subsets: "));
+}
+
+TEST_CASE("construction stats add up over calls")
+{
+	chef::construction_stats stats;
+	auto const nfa_result = chef::to_nfa(chef::parse_re("ab*"));
+	chef::to_dfa(nfa_result.nfa, {nfa_result.accepts}, chef::dfa_kind::complete, &stats);
+	std::size_t const probes = stats.subset_probes;
+	chef::to_dfa(nfa_result.nfa, {nfa_result.accepts}, chef::dfa_kind::complete, &stats);
+
+	CHECK(stats.subset_probes == 2 * probes);
+}
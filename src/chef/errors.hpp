@@ -21,4 +21,47 @@ namespace chef {
 	public:
 		using chef_error::chef_error;
 	};
+
+	// The limit of a chef::budget which was reached.
+	enum class budget_limit {
+		states,
+		bytes,
+		steps,
+		time,
+		cancelled,
+	};
+
+	// A construction stopped because it would have gone over its chef::budget.
+	class construction_budget_error : public construction_error {
+	private:
+		budget_limit limit_;
+
+	public:
+		explicit construction_budget_error(budget_limit limit, char const* what)
+			: construction_error(what)
+			, limit_(limit)
+		{ }
+
+		budget_limit limit() const
+		{
+			return limit_;
+		}
+	};
+
+	// A match stopped because it would have gone over its chef::budget.
+	class evaluation_budget_error : public evaluation_error {
+	private:
+		budget_limit limit_;
+
+	public:
+		explicit evaluation_budget_error(budget_limit limit, char const* what)
+			: evaluation_error(what)
+			, limit_(limit)
+		{ }
+
+		budget_limit limit() const
+		{
+			return limit_;
+		}
+	};
 }
@@ -0,0 +1,467 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include <chef/dfa/fa.hpp>
+#include <chef/errors.hpp>
+
+// A compile-time version of the RE -> NFA -> DFA -> minimal DFA pipeline.
+//
+// The runtime pipeline (chef::parse_re, chef::to_nfa, chef::to_dfa, chef::minimize) uses
+// node-based containers, which cannot be used in constant expressions. This pipeline instead
+// uses fixed-capacity arrays whose sizes are derived from the length of the pattern, so that
+//
+//     constexpr auto m = chef::compile<"a(b|c)*">();
+//
+// places the minimized transition table into read-only data.
+//
+// The pattern syntax is the same as for chef::parse_re; compile.test.cpp checks that both parsers
+// accept and reject the same patterns.
+
+namespace chef {
+	template <std::size_t N>
+	struct fixed_string {
+		char value[N] = {};
+
+		constexpr fixed_string(char const (&str)[N])
+		{
+			std::copy_n(str, N, value);
+		}
+
+		constexpr auto view() const -> std::string_view
+		{
+			return std::string_view(value, N - 1);
+		}
+	};
+
+	// A DFA whose size is known at compile time.
+	template <std::size_t NumStates, std::size_t NumSymbols>
+	class static_dfa {
+		static_assert(NumSymbols < 256, "Every symbol and the reject marker must fit in a byte");
+
+	private:
+		// [byte] -> symbol. Bytes outside of the alphabet are NumSymbols.
+		std::array<chef::symbol_type, 256> byte_symbols_;
+		// A 2d array.
+		std::array<chef::state_type, NumStates * NumSymbols> transition_table_;
+		std::array<bool, NumStates> accepts_;
+
+	public:
+		constexpr explicit static_dfa(std::array<chef::symbol_type, 256> const& byte_symbols,
+			std::array<chef::state_type, NumStates * NumSymbols> const& transition_table,
+			std::array<bool, NumStates> const& accepts)
+			: byte_symbols_(byte_symbols)
+			, transition_table_(transition_table)
+			, accepts_(accepts)
+		{ }
+
+	public:
+		static constexpr auto num_states() -> chef::state_type
+		{
+			return NumStates;
+		}
+
+		static constexpr auto num_symbols() -> chef::symbol_type
+		{
+			return NumSymbols;
+		}
+
+		constexpr auto process(chef::state_type from, chef::symbol_type on) const
+			-> chef::state_type
+		{
+			return transition_table_[NumSymbols * from + on];
+		}
+
+		constexpr bool is_accepting(chef::state_type state) const
+		{
+			return accepts_[state];
+		}
+
+		// Whether the whole string is in the language.
+		constexpr bool matches(std::string_view str) const
+		{
+			chef::state_type cur = 0;
+			for (char const c : str) {
+				chef::symbol_type const sym = byte_symbols_[static_cast<unsigned char>(c)];
+				if (sym == NumSymbols) return false;
+				cur = process(cur, sym);
+			}
+			return accepts_[cur];
+		}
+	};
+
+	namespace detail::ct {
+		inline constexpr chef::state_type no_state = chef::state_type(-1);
+
+		// Every state has at most one symbol edge and at most two epsilon edges.
+		struct thompson_state {
+			chef::state_type eps[2] = {no_state, no_state};
+			chef::state_type to = no_state;
+			chef::symbol_type on = 0;
+		};
+
+		// An upper bound on the number of Thompson NFA states for a pattern of `length`.
+		// Each character adds at most two states, plus one for an empty alternative after it.
+		constexpr std::size_t max_nfa_states(std::size_t length)
+		{
+			return 3 * length + 2;
+		}
+
+		template <std::size_t MaxStates>
+		struct thompson_nfa {
+			std::array<thompson_state, MaxStates> states = {};
+			chef::state_type num_states = 0;
+			chef::state_type start = 0;
+			chef::state_type accept = 0;
+
+			// [byte] -> symbol; -1 for bytes outside of the alphabet.
+			std::array<std::int16_t, 256> byte_symbols = {};
+			std::size_t num_symbols = 0;
+		};
+
+		template <std::size_t MaxStates>
+		class thompson_builder {
+		private:
+			struct fragment {
+				chef::state_type start;
+				chef::state_type accept;
+			};
+
+			std::string_view pattern;
+			std::size_t pos = 0;
+			thompson_nfa<MaxStates> nfa;
+
+		public:
+			constexpr explicit thompson_builder(std::string_view pattern)
+				: pattern(pattern)
+			{
+				nfa.byte_symbols.fill(-1);
+			}
+
+			constexpr auto build() -> thompson_nfa<MaxStates>
+			{
+				fragment const result = parse_union();
+				if (pos != pattern.size()) {
+					throw chef::construction_error("Invalid regular expression: unmatched `)`");
+				}
+				nfa.start = result.start;
+				nfa.accept = result.accept;
+				return nfa;
+			}
+
+		private:
+			constexpr chef::state_type new_state()
+			{
+				if (nfa.num_states == MaxStates) {
+					throw chef::construction_error("Too many NFA states");
+				}
+				// Set explicitly: GCC 12 can constant-evaluate the array's value-initialization
+				// with zeros instead of the member initializers.
+				nfa.states[nfa.num_states] = thompson_state{};
+				return nfa.num_states++;
+			}
+
+			constexpr void add_eps(chef::state_type from, chef::state_type to)
+			{
+				auto& eps = nfa.states[from].eps;
+				(eps[0] == no_state ? eps[0] : eps[1]) = to;
+			}
+
+			constexpr bool at_end() const
+			{
+				return pos == pattern.size();
+			}
+
+			constexpr fragment parse_union()
+			{
+				fragment result = parse_cat();
+				while (!at_end() && pattern[pos] == '|') {
+					++pos;
+					fragment const rhs = parse_cat();
+
+					chef::state_type const start = new_state();
+					chef::state_type const accept = new_state();
+					add_eps(start, result.start);
+					add_eps(start, rhs.start);
+					add_eps(result.accept, accept);
+					add_eps(rhs.accept, accept);
+					result = fragment{start, accept};
+				}
+				return result;
+			}
+
+			constexpr fragment parse_cat()
+			{
+				chef::state_type const empty = new_state();
+				fragment result{empty, empty};
+				while (!at_end() && pattern[pos] != '|' && pattern[pos] != ')') {
+					fragment const rhs = parse_star();
+					add_eps(result.accept, rhs.start);
+					result.accept = rhs.accept;
+				}
+				return result;
+			}
+
+			constexpr fragment parse_star()
+			{
+				fragment result = parse_atom();
+				while (!at_end() && pattern[pos] == '*') {
+					++pos;
+
+					chef::state_type const start = new_state();
+					chef::state_type const accept = new_state();
+					add_eps(start, result.start);
+					add_eps(start, accept);
+					add_eps(result.accept, result.start);
+					add_eps(result.accept, accept);
+					result = fragment{start, accept};
+				}
+				return result;
+			}
+
+			constexpr fragment parse_atom()
+			{
+				char c = pattern[pos++];
+				if (c == '(') {
+					fragment const result = parse_union();
+					if (at_end() || pattern[pos] != ')') {
+						throw chef::construction_error("Invalid regular expression: expected `)`");
+					}
+					++pos;
+					return result;
+				} else if (c == '*') {
+					throw chef::construction_error(
+						"Invalid regular expression: `*` must follow an expression");
+				} else if (c == '\\') {
+					if (at_end()) {
+						throw chef::construction_error("Invalid regular expression: dangling `\\`");
+					}
+					c = pattern[pos++];
+				}
+
+				auto& symbol = nfa.byte_symbols[static_cast<unsigned char>(c)];
+				if (symbol < 0) {
+					symbol = static_cast<std::int16_t>(nfa.num_symbols++);
+				}
+
+				chef::state_type const start = new_state();
+				chef::state_type const accept = new_state();
+				nfa.states[start].to = accept;
+				nfa.states[start].on = static_cast<chef::symbol_type>(symbol);
+				return fragment{start, accept};
+			}
+		};
+
+		template <std::size_t NumNfaStates>
+		struct state_set {
+			std::array<std::uint64_t, (NumNfaStates + 63) / 64> bits = {};
+
+			constexpr bool contains(chef::state_type state) const
+			{
+				return (bits[state / 64] >> (state % 64)) & 1;
+			}
+
+			constexpr void insert(chef::state_type state)
+			{
+				bits[state / 64] |= std::uint64_t(1) << (state % 64);
+			}
+
+			friend constexpr bool operator==(state_set const&, state_set const&) = default;
+		};
+
+		template <std::size_t MaxDfaStates, std::size_t MaxSymbols>
+		struct dfa_result {
+			std::size_t num_states = 0;
+			std::size_t num_symbols = 0;
+			std::array<chef::state_type, MaxDfaStates * MaxSymbols> transition_table = {};
+			std::array<bool, MaxDfaStates> accepts = {};
+			std::array<std::int16_t, 256> byte_symbols = {};
+		};
+
+		// Powerset construction over the Thompson NFA.
+		template <std::size_t MaxDfaStates, std::size_t MaxSymbols, std::size_t MaxNfaStates>
+		constexpr auto to_dfa(thompson_nfa<MaxNfaStates> const& nfa)
+			-> dfa_result<MaxDfaStates, MaxSymbols>
+		{
+			using set_type = state_set<MaxNfaStates>;
+
+			auto const closure = [&nfa](set_type set) {
+				std::array<chef::state_type, MaxNfaStates> stack = {};
+				std::size_t size = 0;
+				for (chef::state_type state = 0; state < nfa.num_states; ++state) {
+					if (set.contains(state)) stack[size++] = state;
+				}
+				while (size != 0) {
+					chef::state_type const cur = stack[--size];
+					for (chef::state_type const next : nfa.states[cur].eps) {
+						if (next != no_state && !set.contains(next)) {
+							set.insert(next);
+							stack[size++] = next;
+						}
+					}
+				}
+				return set;
+			};
+
+			dfa_result<MaxDfaStates, MaxSymbols> result;
+			result.num_symbols = nfa.num_symbols;
+			result.byte_symbols = nfa.byte_symbols;
+
+			std::array<set_type, MaxDfaStates> mstates = {};
+			{
+				set_type start;
+				start.insert(nfa.start);
+				mstates[0] = closure(start);
+				result.num_states = 1;
+			}
+
+			// States are numbered in discovery order, so the unprocessed ones are a FIFO queue.
+			for (std::size_t cur = 0; cur < result.num_states; ++cur) {
+				for (std::size_t sym = 0; sym < nfa.num_symbols; ++sym) {
+					set_type next;
+					for (chef::state_type state = 0; state < nfa.num_states; ++state) {
+						if (mstates[cur].contains(state) && nfa.states[state].to != no_state
+							&& nfa.states[state].on == sym)
+						{
+							next.insert(nfa.states[state].to);
+						}
+					}
+					next = closure(next);
+
+					std::size_t index = 0;
+					while (index < result.num_states && !(mstates[index] == next)) {
+						++index;
+					}
+					if (index == result.num_states) {
+						if (result.num_states == MaxDfaStates) {
+							throw chef::construction_error("Too many DFA states");
+						}
+						mstates[result.num_states++] = next;
+					}
+
+					result.transition_table[cur * MaxSymbols + sym]
+						= static_cast<chef::state_type>(index);
+				}
+
+				result.accepts[cur] = mstates[cur].contains(nfa.accept);
+			}
+
+			return result;
+		}
+
+		// Moore's partition refinement. Blocks are numbered by their first state, so the start
+		// state stays 0.
+		template <std::size_t MaxDfaStates, std::size_t MaxSymbols>
+		constexpr auto minimize(dfa_result<MaxDfaStates, MaxSymbols> const& dfa)
+			-> dfa_result<MaxDfaStates, MaxSymbols>
+		{
+			std::array<chef::state_type, MaxDfaStates> block = {};
+			std::size_t num_blocks = 0;
+
+			// Initial partition: accepting vs. not.
+			for (std::size_t state = 0; state < dfa.num_states; ++state) {
+				block[state] = dfa.accepts[state] == dfa.accepts[0] ? 0 : 1;
+				num_blocks = std::max<std::size_t>(num_blocks, block[state] + 1);
+			}
+
+			while (true) {
+				std::array<chef::state_type, MaxDfaStates> next_block = {};
+				// The first state of each new block.
+				std::array<std::size_t, MaxDfaStates> representative = {};
+				std::size_t num_next_blocks = 0;
+
+				for (std::size_t state = 0; state < dfa.num_states; ++state) {
+					auto const same_signature = [&](std::size_t other) {
+						if (block[state] != block[other]) return false;
+						for (std::size_t sym = 0; sym < dfa.num_symbols; ++sym) {
+							if (block[dfa.transition_table[state * MaxSymbols + sym]]
+								!= block[dfa.transition_table[other * MaxSymbols + sym]])
+							{
+								return false;
+							}
+						}
+						return true;
+					};
+
+					std::size_t index = 0;
+					while (index < num_next_blocks && !same_signature(representative[index])) {
+						++index;
+					}
+					if (index == num_next_blocks) {
+						representative[num_next_blocks++] = state;
+					}
+					next_block[state] = static_cast<chef::state_type>(index);
+				}
+
+				block = next_block;
+				if (num_next_blocks == num_blocks) break;
+				num_blocks = num_next_blocks;
+			}
+
+			dfa_result<MaxDfaStates, MaxSymbols> result;
+			result.num_states = num_blocks;
+			result.num_symbols = dfa.num_symbols;
+			result.byte_symbols = dfa.byte_symbols;
+			for (std::size_t state = 0; state < dfa.num_states; ++state) {
+				for (std::size_t sym = 0; sym < dfa.num_symbols; ++sym) {
+					result.transition_table[block[state] * MaxSymbols + sym]
+						= block[dfa.transition_table[state * MaxSymbols + sym]];
+				}
+				result.accepts[block[state]] = dfa.accepts[state];
+			}
+
+			return result;
+		}
+
+		constexpr std::size_t max_symbols(std::size_t length)
+		{
+			return std::min<std::size_t>(length, 256) + 1;
+		}
+
+		template <chef::fixed_string Pattern, std::size_t MaxDfaStates>
+		constexpr auto compile()
+		{
+			constexpr std::size_t length = Pattern.view().size();
+
+			auto const nfa = thompson_builder<max_nfa_states(length)>(Pattern.view()).build();
+			return detail::ct::minimize(
+				detail::ct::to_dfa<MaxDfaStates, ct::max_symbols(length)>(nfa));
+		}
+	}
+
+	/**
+	 * \brief Compiles the pattern into a minimal DFA at compile time
+	 *
+	 * \tparam Pattern A regular expression, in the syntax of chef::parse_re
+	 * \tparam MaxDfaStates The capacity for the unminimized DFA
+	 */
+	template <chef::fixed_string Pattern, std::size_t MaxDfaStates = 256>
+	constexpr auto compile()
+	{
+		constexpr auto result = detail::ct::compile<Pattern, MaxDfaStates>();
+		constexpr std::size_t max_symbols = detail::ct::max_symbols(Pattern.view().size());
+
+		std::array<chef::symbol_type, 256> byte_symbols = {};
+		for (std::size_t byte = 0; byte < 256; ++byte) {
+			byte_symbols[byte] = static_cast<chef::symbol_type>(
+				result.byte_symbols[byte] < 0 ? result.num_symbols : result.byte_symbols[byte]);
+		}
+
+		std::array<chef::state_type, result.num_states * result.num_symbols> transition_table = {};
+		std::array<bool, result.num_states> accepts = {};
+		for (std::size_t state = 0; state < result.num_states; ++state) {
+			for (std::size_t sym = 0; sym < result.num_symbols; ++sym) {
+				transition_table[state * result.num_symbols + sym]
+					= result.transition_table[state * max_symbols + sym];
+			}
+			accepts[state] = result.accepts[state];
+		}
+
+		return chef::static_dfa<result.num_states, result.num_symbols>(
+			byte_symbols, transition_table, accepts);
+	}
+}
@@ -0,0 +1,74 @@
+#include "./compile.hpp"
+
+#include <chef/errors.hpp>
+#include <chef/re/engines/dfa.hpp>
+#include <chef/re/parse.hpp>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("re compiles to a minimal DFA at compile time")
+{
+	constexpr auto dfa = chef::compile<"a(b|c)*">();
+
+	static_assert(dfa.num_states() == 3); // start, a(b|c)*, and the dead state
+	static_assert(dfa.num_symbols() == 3);
+	static_assert(dfa.matches("a"));
+	static_assert(dfa.matches("abccb"));
+	static_assert(!dfa.matches(""));
+	static_assert(!dfa.matches("ba"));
+	static_assert(!dfa.matches("abd"));
+
+	CHECK(dfa.matches("acb"));
+	CHECK_FALSE(dfa.matches("aa"));
+}
+
+TEST_CASE("re compiles escapes and empty alternatives at compile time")
+{
+	constexpr auto dfa = chef::compile<"\\(\\*|()">();
+
+	static_assert(dfa.matches("(*"));
+	static_assert(dfa.matches(""));
+	static_assert(!dfa.matches("("));
+}
+
+TEST_CASE("re compiled at compile time agrees with the runtime pipeline")
+{
+	constexpr auto dfa = chef::compile<"(Hello, World!|(a(b|c))*)*">();
+	chef::re const re = chef::parse_re("(Hello, World!|(a(b|c))*)*");
+
+	for (std::string_view const str : {"", "a", "ab", "abac", "Hello, World!",
+			 "Hello, World!abababacacHello, World!", "Doesn't match", "abHello"})
+	{
+		CAPTURE(str);
+		CHECK(dfa.matches(str) == chef::re_dfa_engine::matches(re, str));
+	}
+}
+
+TEST_CASE("re compile-time parser accepts and rejects the same patterns as chef::parse_re")
+{
+	constexpr std::size_t max_length = 32;
+	using builder
+		= chef::detail::ct::thompson_builder<chef::detail::ct::max_nfa_states(max_length)>;
+
+	auto const accepts = [](auto const& parse) {
+		try {
+			parse();
+			return true;
+		} catch (chef::construction_error const&) {
+			return false;
+		}
+	};
+
+	for (std::string_view const pattern : {"", "a", "ab|c", "a(b|c)*", "(a|b)*c**", "|", "a|",
+			 "()", "(|)", "((a))", "\\(\\*|()", "\\\\", "\\a", "a&b", "~a", "(", ")", "(a",
+			 "a)", "(a))", "*", "*a", "a|*", "(*)", "a\\", "\\", "(a|b"})
+	{
+		REQUIRE(pattern.size() <= max_length);
+		CAPTURE(pattern);
+
+		bool const runtime_accepts = accepts([&] { chef::parse_re(pattern); });
+		bool const compile_time_accepts = accepts([&] { builder(pattern).build(); });
+
+		CHECK(runtime_accepts == compile_time_accepts);
+	}
+}
@@ -13,6 +13,7 @@
 #include <chef/_/fwd.hpp>
 #include <chef/_/overload.hpp>
 #include <chef/_/ranges.hpp>
+#include <chef/errors.hpp>
 
 using chef::detail::DecaysOneOf;
 using chef::detail::overload;
@@ -107,7 +108,8 @@ namespace {
 		}
 
 		void make_next_back_edges(chef::re const*,
-			DecaysOneOf<chef::re_lit, chef::re_empty, chef::re_char_class> auto const&)
+			DecaysOneOf<chef::re_lit, chef::re_empty, chef::re_char_class, chef::re_and,
+				chef::re_not> auto const&)
 		{ }
 
 		void make_lasts(chef::re const* re_p)
@@ -146,7 +148,8 @@ namespace {
 		}
 
 		void make_lasts(chef::re const*,
-			DecaysOneOf<chef::re_lit, chef::re_empty, chef::re_char_class> auto const&)
+			DecaysOneOf<chef::re_lit, chef::re_empty, chef::re_char_class, chef::re_and,
+				chef::re_not> auto const&)
 		{ }
 	};
 
@@ -169,8 +172,11 @@ namespace {
 			: engine(re, engine_builder(re))
 		{ }
 
-		bool matches(std::string_view str) const
+		template <typename Stats>
+		bool matches(std::string_view str, Stats& stats, chef::budget const& budget) const
 		{
+			chef::detail::budget_meter meter(budget);
+
 			struct state {
 				chef::re const* cur;
 				std::string_view remaining;
@@ -187,11 +193,14 @@ namespace {
 			std::unordered_map<chef::re const*, std::string_view> last_remaining;
 
 			do {
+				meter.step();
+				stats.transition();
 				state& cur = stack.top();
 				last_remaining.insert_or_assign(cur.cur, cur.remaining);
 				if (cur.remaining.empty() && accept.contains(cur.cur)) return true;
 
 				auto const backtrack = [&] {
+					stats.backtrack();
 					last_remaining.erase(cur.cur);
 					stack.pop();
 				};
@@ -271,6 +280,10 @@ namespace {
 						[&](DecaysOneOf<chef::re_empty, chef::re_char_class> auto const&) {
 							backtrack();
 						},
+						[&](DecaysOneOf<chef::re_and, chef::re_not> auto const&) {
+							throw chef::evaluation_error(
+								"The backtracking engine does not support & and ~");
+						},
 					},
 					cur.cur->value);
 			} while (!stack.empty());
@@ -281,10 +294,16 @@ namespace {
 }
 
 namespace chef {
-	bool re_backtracking_engine::matches(chef::re const& re, std::string_view str)
+	template <typename Stats>
+	bool basic_re_backtracking_engine<Stats>::matches(
+		chef::re const& re, std::string_view str, Stats& stats, chef::budget const& budget)
 	{
+		stats.begin_match();
 		re.to_string();
 		::engine engine(re);
-		return engine.matches(str);
+		return engine.matches(str, stats, budget);
 	}
+
+	template struct basic_re_backtracking_engine<chef::no_match_stats>;
+	template struct basic_re_backtracking_engine<chef::counting_match_stats>;
 }
@@ -2,10 +2,28 @@
 
 #include <string_view>
 
+#include <chef/budget.hpp>
+#include <chef/re/engines/match_stats.hpp>
 #include <chef/re/re.hpp>
 
 namespace chef {
-	struct re_backtracking_engine {
-		static bool matches(chef::re const& re, std::string_view str);
+	// Matches by a depth-first walk of the pieces of the RE, telling Stats of each step and each
+	// backtrack.
+	template <typename Stats = chef::no_match_stats>
+	struct basic_re_backtracking_engine {
+		static bool matches(
+			chef::re const& re, std::string_view str, chef::budget const& budget = {})
+		{
+			Stats stats;
+			return matches(re, str, stats, budget);
+		}
+
+		static bool matches(chef::re const& re, std::string_view str, Stats& stats,
+			chef::budget const& budget = {});
 	};
+
+	extern template struct basic_re_backtracking_engine<chef::no_match_stats>;
+	extern template struct basic_re_backtracking_engine<chef::counting_match_stats>;
+
+	using re_backtracking_engine = basic_re_backtracking_engine<>;
 }
@@ -61,12 +61,33 @@ namespace chef {
 				[c](re_star star) -> re {
 					return chef::derivative(*star.value, c) << re(CHEF_MOVE(star));
 				},
+				[c](re_and both) -> re {
+					re result = chef::derivative(*both.pieces.front(), c);
+					for (auto const& piece : both.pieces | views::drop(1)) {
+						result = CHEF_MOVE(result) & chef::derivative(*piece, c);
+					}
+					return result;
+				},
+				[c](re_not negated) -> re { return ~chef::derivative(*negated.value, c); },
 			},
 			re_in.value);
 	}
 
-	bool re_derivative_engine::matches(chef::re const& re, std::string_view str)
+	template <typename Stats>
+	bool basic_re_derivative_engine<Stats>::matches(
+		chef::re const& re, std::string_view str, Stats& stats, chef::budget const& budget)
 	{
-		return chef::derivative(re, str).is_vanishable();
+		stats.begin_match();
+		chef::detail::budget_meter meter(budget);
+		chef::re cur = re;
+		for (char const c : str) {
+			meter.step();
+			stats.transition();
+			cur = chef::derivative(cur, c);
+		}
+		return cur.is_vanishable();
 	}
+
+	template struct basic_re_derivative_engine<chef::no_match_stats>;
+	template struct basic_re_derivative_engine<chef::counting_match_stats>;
 }
@@ -2,13 +2,31 @@
 
 #include <string_view>
 
+#include <chef/budget.hpp>
+#include <chef/re/engines/match_stats.hpp>
 #include <chef/re/re.hpp>
 
 namespace chef {
-	struct re_derivative_engine {
-		static bool matches(chef::re const& re, std::string_view str);
+	// Matches by taking the derivative of the RE by each character in turn, telling Stats of
+	// each one as a transition.
+	template <typename Stats = chef::no_match_stats>
+	struct basic_re_derivative_engine {
+		static bool matches(
+			chef::re const& re, std::string_view str, chef::budget const& budget = {})
+		{
+			Stats stats;
+			return matches(re, str, stats, budget);
+		}
+
+		static bool matches(chef::re const& re, std::string_view str, Stats& stats,
+			chef::budget const& budget = {});
 	};
 
+	extern template struct basic_re_derivative_engine<chef::no_match_stats>;
+	extern template struct basic_re_derivative_engine<chef::counting_match_stats>;
+
+	using re_derivative_engine = basic_re_derivative_engine<>;
+
 	auto derivative(chef::re const& re, char c) -> chef::re;
 	auto derivative(chef::re const& re, std::string_view str) -> chef::re;
 }
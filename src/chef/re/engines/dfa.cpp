@@ -1,5 +1,9 @@
 #include "./dfa.hpp"
 
+#include <algorithm>
+
+#include <tl/tl.hpp>
+
 #include <chef/dfa/convert.hpp>
 #include <chef/dfa/minimize.hpp>
 #include <chef/re/to_nfa.hpp>
@@ -11,23 +15,48 @@ using ranges::begin;
 using ranges::end;
 
 namespace chef {
-	bool re_dfa_engine::matches(chef::re const& re, std::string_view str)
+	template <typename Stats>
+	bool basic_re_dfa_engine<Stats>::matches(
+		chef::re const& re, std::string_view str, Stats& stats, chef::budget const& budget)
 	{
-		auto nfa_result = chef::to_nfa(re);
+		stats.begin_match();
+		auto nfa_result = chef::to_nfa(re, nullptr, budget);
 
 		std::vector<std::unordered_set<state_type>> categories;
 		categories.push_back(CHEF_MOVE(nfa_result.accepts));
 
-		auto [dfa, dfa_categories] = chef::to_dfa(nfa_result.nfa, categories);
-		auto [min_dfa, min_dfa_categories] = chef::minimize(dfa, dfa_categories);
+		auto [dfa, dfa_categories]
+			= chef::to_dfa(nfa_result.nfa, categories, chef::dfa_kind::partial, nullptr, budget);
+		auto const minimized = chef::minimize(dfa, dfa_categories);
+		chef::dfa const& min_dfa = minimized.first;
+		// minimize() marks the sinks of the states.
+		chef::category_view const accepts = minimized.second[0];
 
-		chef::state_type cur = 0;
-		for (const char c : str) {
-			auto it = nfa_result.symbol_map.find(c);
-			if (it == nfa_result.symbol_map.end()) return false;
-			cur = min_dfa.process(cur, it->second);
-		}
+		return min_dfa.visit_table([&](auto const table) {
+			std::size_t row = min_dfa.row(0);
+			for (auto first = str.begin(); first != str.end(); ++first) {
+				// Stop as soon as the rest of the input can't change the answer.
+				chef::sink_kind const sink = accepts.sink(min_dfa.state(row));
+				// The rest of the input isn't run through the table, even if it is checked below.
+				if (sink != chef::sink_kind::none) stats.skip(str.end() - first);
+				if (sink == chef::sink_kind::dead) return false;
+				if (sink == chef::sink_kind::accept_forever) {
+					// Characters outside of the alphabet still fail the match.
+					return std::all_of(
+						first, str.end(), [&] TL(nfa_result.symbol_map.contains(_1)));
+				}
 
-		return min_dfa_categories[0].contains(cur);
+				auto it = nfa_result.symbol_map.find(*first);
+				if (it == nfa_result.symbol_map.end()) return false;
+				stats.transition();
+				row = table[row + it->second];
+				if (row == min_dfa.row(min_dfa.dead_state())) return false;
+			}
+
+			return accepts.contains(min_dfa.state(row));
+		});
 	}
+
+	template struct basic_re_dfa_engine<chef::no_match_stats>;
+	template struct basic_re_dfa_engine<chef::counting_match_stats>;
 }
@@ -1,6 +1,13 @@
 #include <chef/re/engines/backtracking.hpp>
 #include <chef/re/engines/derivative.hpp>
 #include <chef/re/engines/dfa.hpp>
+#include <chef/re/engines/jit.hpp>
+
+#include <sstream>
+#include <string>
+#include <type_traits>
+
+#include <chef/_/fwd.hpp>
 
 #include <catch2/catch.hpp>
 
@@ -9,7 +16,18 @@ namespace {
 	struct type_list { };
 }
 
-using engines = type_list<chef::re_derivative_engine, chef::re_dfa_engine>;
+namespace {
+	// Always uses the portable matcher, even where the native code generator works.
+	struct re_interpreted_jit_engine {
+		static bool matches(chef::re const& re, std::string_view str)
+		{
+			return chef::re_jit_engine::matches(re, str, chef::jit_mode::interpreted);
+		}
+	};
+}
+
+using engines = type_list<chef::re_derivative_engine, chef::re_dfa_engine, chef::re_jit_engine,
+	re_interpreted_jit_engine>;
 
 TEMPLATE_LIST_TEST_CASE("Simple match", "", engines)
 {
@@ -52,3 +70,104 @@ TEMPLATE_LIST_TEST_CASE("Epsilon transitions", "", engines)
 	// Not allowed to switch between options:
 	CHECK_FALSE(Engine::matches(re, "aabba"));
 }
+
+TEMPLATE_LIST_TEST_CASE("Decided matches still respect the rest of the input", "", engines)
+{
+	using Engine = TestType;
+	chef::re const re = chef::re("ab") << *(chef::re("a") | chef::re("b"));
+
+	CHECK(Engine::matches(re, "abba"));
+	CHECK_FALSE(Engine::matches(re, "ba"));
+	CHECK_FALSE(Engine::matches(re, "bababab"));
+	// Every string of a's and b's is accepted after "ab", but not other characters:
+	CHECK_FALSE(Engine::matches(re, "abbac"));
+}
+
+TEMPLATE_LIST_TEST_CASE("Intersection and complement", "", engines)
+{
+	using Engine = TestType;
+	chef::re const a_or_b = chef::re("a") | chef::re("b");
+	// Strings of a's and b's which contain "ab" but not "ba".
+	chef::re const any = *a_or_b;
+	chef::re const re = (any << chef::re("ab") << any) & ~(any << chef::re("ba") << any);
+
+	CHECK(Engine::matches(re, "ab"));
+	CHECK(Engine::matches(re, "aabbb"));
+	CHECK_FALSE(Engine::matches(re, "aba"));
+	CHECK_FALSE(Engine::matches(re, "a"));
+	CHECK_FALSE(Engine::matches(re, ""));
+
+	// The complement includes characters which the RE doesn't mention.
+	chef::re const not_a = ~chef::re("a");
+	CHECK(Engine::matches(not_a, ""));
+	CHECK(Engine::matches(not_a, "b"));
+	CHECK(Engine::matches(not_a, "aa"));
+	CHECK_FALSE(Engine::matches(not_a, "a"));
+}
+
+TEST_CASE("Engines stop at their budget")
+{
+	chef::re const any = *(chef::re("a") | chef::re("b"));
+	std::string const str(1000, 'a');
+
+	CHECK(chef::re_derivative_engine::matches(any, str, {.max_steps = 1000}));
+	CHECK_THROWS_AS(chef::re_derivative_engine::matches(any, str, {.max_steps = 999}),
+		chef::evaluation_budget_error);
+	CHECK_THROWS_AS(chef::re_backtracking_engine::matches(any, str, {.max_steps = 100}),
+		chef::evaluation_budget_error);
+
+	// (a|b)*a(a|b)^11 has 4096 DFA states.
+	chef::re re = any << chef::re("a");
+	for (int i = 0; i < 11; ++i) {
+		re = CHEF_MOVE(re) << (chef::re("a") | chef::re("b"));
+	}
+	CHECK_THROWS_AS(chef::re_dfa_engine::matches(re, "ab", {.max_states = 1000}),
+		chef::construction_budget_error);
+	CHECK_THROWS_AS(chef::re_jit_engine::matches(
+						re, "ab", chef::jit_mode::interpreted, {.max_states = 1000}),
+		chef::construction_budget_error);
+
+	// The DFAs built for & and ~ must keep to the budget too. The intersection with "b" is
+	// small, so only the complement inside it goes over.
+	chef::re const small = ~re & chef::re("b");
+	CHECK(chef::re_dfa_engine::matches(small, "b"));
+	CHECK_THROWS_AS(chef::re_dfa_engine::matches(small, "b", {.max_states = 1000}),
+		chef::construction_budget_error);
+	CHECK_THROWS_AS(chef::re_jit_engine::matches(
+						small, "b", chef::jit_mode::interpreted, {.max_states = 1000}),
+		chef::construction_budget_error);
+}
+
+TEST_CASE("Engines count what they do")
+{
+	static_assert(std::is_empty_v<chef::no_match_stats>);
+	using counting = chef::counting_match_stats;
+	chef::re const re = chef::re("ab") << *(chef::re("a") | chef::re("b"));
+
+	counting stats;
+	CHECK(chef::basic_re_derivative_engine<counting>::matches(re, "abba", stats));
+	CHECK(stats.last().transitions == 4);
+
+	// Nothing after "ab" can fail the match, so the DFA stops there.
+	CHECK(chef::basic_re_dfa_engine<counting>::matches(re, "abba", stats));
+	CHECK(stats.last() == chef::match_counters{.transitions = 2, .skipped_bytes = 2});
+	CHECK(stats.total().transitions == 6);
+
+	// The first choice of the union fails.
+	CHECK(chef::basic_re_backtracking_engine<counting>::matches(
+		chef::re("a") | chef::re("b"), "b", stats));
+	CHECK(stats.last().backtracks > 0);
+	CHECK(stats.total().backtracks == stats.last().backtracks);
+
+	std::ostringstream out;
+	out << stats.total();
+	CHECK_THAT(out.str(), Catch::Contains("skipped bytes: 2\n"));
+
+	// The portable matcher looks up every byte; native code can only skip them all.
+	counting jit_stats;
+	CHECK(chef::basic_re_jit_engine<counting>::matches(
+		re, "abba", jit_stats, chef::jit_mode::interpreted));
+	CHECK(jit_stats.last() == chef::match_counters{.transitions = 4});
+	CHECK(chef::basic_re_jit_engine<counting>::matches(re, "abba", jit_stats));
+	CHECK(jit_stats.last().transitions + jit_stats.last().skipped_bytes == 4);
+}
@@ -0,0 +1,28 @@
+#include "./jit.hpp"
+
+#include <chef/dfa/convert.hpp>
+#include <chef/dfa/minimize.hpp>
+#include <chef/re/to_nfa.hpp>
+
+namespace chef {
+	template <typename Stats>
+	bool basic_re_jit_engine<Stats>::matches(chef::re const& re, std::string_view str,
+		Stats& stats, chef::jit_mode mode, chef::budget const& budget)
+	{
+		stats.begin_match();
+		auto nfa_result = chef::to_nfa(re, nullptr, budget);
+
+		std::vector<std::unordered_set<state_type>> categories;
+		categories.push_back(CHEF_MOVE(nfa_result.accepts));
+
+		auto [dfa, dfa_categories]
+			= chef::to_dfa(nfa_result.nfa, categories, chef::dfa_kind::partial, nullptr, budget);
+		auto [min_dfa, min_dfa_categories] = chef::minimize(dfa, dfa_categories);
+
+		chef::jit_dfa const jit(min_dfa, min_dfa_categories[0], nfa_result.symbol_map, mode);
+		return jit.matches(str, stats);
+	}
+
+	template struct basic_re_jit_engine<chef::no_match_stats>;
+	template struct basic_re_jit_engine<chef::counting_match_stats>;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string_view>
+
+#include <chef/budget.hpp>
+#include <chef/dfa/jit.hpp>
+#include <chef/re/engines/match_stats.hpp>
+#include <chef/re/re.hpp>
+
+namespace chef {
+	// Matches with the minimal DFA of the RE, run by a chef::jit_dfa. Stats is told of each
+	// transition of the portable matcher; native code can only tell it that every byte was
+	// skipped. See chef/re/engines/match_stats.hpp.
+	template <typename Stats = chef::no_match_stats>
+	struct basic_re_jit_engine {
+		static bool matches(chef::re const& re, std::string_view str,
+			chef::jit_mode mode = chef::jit_mode::native, chef::budget const& budget = {})
+		{
+			Stats stats;
+			return matches(re, str, stats, mode, budget);
+		}
+
+		static bool matches(chef::re const& re, std::string_view str, Stats& stats,
+			chef::jit_mode mode = chef::jit_mode::native, chef::budget const& budget = {});
+	};
+
+	extern template struct basic_re_jit_engine<chef::no_match_stats>;
+	extern template struct basic_re_jit_engine<chef::counting_match_stats>;
+
+	using re_jit_engine = basic_re_jit_engine<>;
+}
@@ -0,0 +1,13 @@
+#include "./match_stats.hpp"
+
+#include <ostream>
+
+namespace chef {
+	auto operator<<(std::ostream& out, match_counters const& counters) -> std::ostream&
+	{
+		return out << "transitions: " << counters.transitions << '\n'
+				   << "cache misses: " << counters.cache_misses << '\n'
+				   << "backtracks: " << counters.backtracks << '\n'
+				   << "skipped bytes: " << counters.skipped_bytes << '\n';
+	}
+}
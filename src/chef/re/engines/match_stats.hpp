@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+
+namespace chef {
+	// What the matching engines did, event by event.
+	struct match_counters {
+		// The transitions taken, such as DFA table lookups, derivatives or backtracking steps.
+		std::size_t transitions = 0;
+		// The times a lazily built automaton had to build a missing state.
+		std::size_t cache_misses = 0;
+		// The times a backtracking engine gave up on a path.
+		std::size_t backtracks = 0;
+		// The bytes not run through the transition table, such as those passed over by a
+		// prefilter or read once the DFA can't change its answer. The latter may still be
+		// checked against the alphabet.
+		std::size_t skipped_bytes = 0;
+
+		auto operator+=(match_counters const& rhs) -> match_counters&
+		{
+			transitions += rhs.transitions;
+			cache_misses += rhs.cache_misses;
+			backtracks += rhs.backtracks;
+			skipped_bytes += rhs.skipped_bytes;
+			return *this;
+		}
+
+		friend bool operator==(match_counters const&, match_counters const&) = default;
+
+		// Writes one line per counter, for people.
+		friend auto operator<<(std::ostream& out, match_counters const& counters)
+			-> std::ostream&;
+	};
+
+	// The stats policy of the matching engines which measures nothing. Its hooks are those every
+	// policy has: begin_match() starts each match, and the rest are called as the events
+	// happen. They are all empty here, so the calls compile away.
+	struct no_match_stats {
+		void begin_match() { }
+		void transition() { }
+		void cache_miss() { }
+		void backtrack() { }
+		void skip(std::size_t) { }
+	};
+
+	// The stats policy which counts every event, both for the last match and over all matches.
+	class counting_match_stats {
+	private:
+		// The counts of matches before the last one.
+		match_counters earlier_;
+		match_counters last_;
+
+	public:
+		void begin_match()
+		{
+			earlier_ += last_;
+			last_ = {};
+		}
+
+		void transition()
+		{
+			++last_.transitions;
+		}
+
+		void cache_miss()
+		{
+			++last_.cache_misses;
+		}
+
+		void backtrack()
+		{
+			++last_.backtracks;
+		}
+
+		void skip(std::size_t bytes)
+		{
+			last_.skipped_bytes += bytes;
+		}
+
+		// The counts of the last match, or of the one in progress.
+		auto last() const -> match_counters const&
+		{
+			return last_;
+		}
+
+		// The counts of every match so far.
+		auto total() const -> match_counters
+		{
+			match_counters total = earlier_;
+			total += last_;
+			return total;
+		}
+	};
+}
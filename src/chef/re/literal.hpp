@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <variant>
+
+#include <chef/_/fwd.hpp>
+#include <chef/_/overload.hpp>
+#include <chef/re/re.hpp>
+
+namespace chef {
+	/**
+	 * \brief Finds a literal which every string in the RE's language contains
+	 *
+	 * This lets a search skip straight to the places the literal occurs (e.g. with memchr) before
+	 * running the DFA. The literal is not always the longest one there is; an empty literal means
+	 * that none was found.
+	 *
+	 * \param re
+	 * \returns A substring of every match
+	 */
+	inline auto required_literal(chef::re const& re) -> std::string
+	{
+		auto const longest = [](auto const& pieces) {
+			std::string result;
+			for (auto const& piece : pieces) {
+				std::string cur = chef::required_literal(*piece);
+				if (cur.size() > result.size()) result = CHEF_MOVE(cur);
+			}
+			return result;
+		};
+
+		// The parser builds a cat of one-character literals, so adjacent literals are joined.
+		auto const longest_in_cat = [](auto const& pieces) {
+			std::string result;
+			std::string run;
+			for (auto const& piece : pieces) {
+				if (auto const* lit = std::get_if<re_lit>(&piece->value)) {
+					run += lit->value;
+					continue;
+				}
+				std::string cur = chef::required_literal(*piece);
+				if (run.size() > result.size()) result = run;
+				if (cur.size() > result.size()) result = CHEF_MOVE(cur);
+				run.clear();
+			}
+			if (run.size() > result.size()) result = CHEF_MOVE(run);
+			return result;
+		};
+
+		auto const common = [](auto const& pieces) {
+			std::string const result = chef::required_literal(*pieces.front());
+			for (auto const& piece : pieces) {
+				if (chef::required_literal(*piece) != result) return std::string();
+			}
+			return result;
+		};
+
+		return std::visit(detail::overload{
+							  [](re_lit const& re) { return re.value; },
+							  [&](re_cat const& re) { return longest_in_cat(re.pieces); },
+							  // Every piece must match, so any piece's literal will do.
+							  [&](re_and const& re) { return longest(re.pieces); },
+							  // Only a literal common to every alternative is required.
+							  [&](re_union const& re) { return common(re.pieces); },
+							  [](auto const&) { return std::string(); },
+						  },
+			re.value);
+	}
+}
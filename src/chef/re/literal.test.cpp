@@ -0,0 +1,23 @@
+#include "./literal.hpp"
+
+#include <chef/re/parse.hpp>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("required literals are found")
+{
+	CHECK(chef::required_literal(chef::parse_re("hello")) == "hello");
+	CHECK(chef::required_literal(chef::parse_re("a*bcd(e|f)*g")) == "bcd");
+	CHECK(chef::required_literal(chef::parse_re("(GET|POST) /index")) == " /index");
+	CHECK(chef::required_literal(chef::parse_re("(ab|ab)c*")) == "ab");
+	CHECK(chef::required_literal(chef::parse_re("long*") & chef::parse_re("x")) == "lon");
+}
+
+TEST_CASE("required literals are empty when nothing is required")
+{
+	CHECK(chef::required_literal(chef::parse_re("")) == "");
+	CHECK(chef::required_literal(chef::parse_re("(abc)*")) == "");
+	CHECK(chef::required_literal(chef::parse_re("abc|abd")) == "");
+	CHECK(chef::required_literal(~chef::parse_re("abc")) == "");
+	CHECK(chef::required_literal(chef::re(chef::re_empty{})) == "");
+}
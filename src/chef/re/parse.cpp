@@ -0,0 +1,107 @@
+#include "./parse.hpp"
+
+#include <string>
+
+#include <chef/_/fwd.hpp>
+#include <chef/errors.hpp>
+
+using namespace std::literals;
+
+namespace {
+	class parser {
+	private:
+		std::string_view pattern;
+		std::size_t pos = 0;
+
+	public:
+		explicit parser(std::string_view pattern)
+			: pattern(pattern)
+		{ }
+
+		chef::re parse()
+		{
+			chef::re result = parse_union();
+			if (pos != pattern.size()) {
+				fail("unmatched `)`");
+			}
+			return result;
+		}
+
+	private:
+		[[noreturn]] void fail(std::string const& message) const
+		{
+			throw chef::construction_error("Invalid regular expression `" + std::string(pattern)
+				+ "` at offset " + std::to_string(pos) + ": " + message);
+		}
+
+		bool at_end() const
+		{
+			return pos == pattern.size();
+		}
+
+		char peek() const
+		{
+			return pattern[pos];
+		}
+
+		chef::re parse_union()
+		{
+			chef::re result = parse_cat();
+			while (!at_end() && peek() == '|') {
+				++pos;
+				result = CHEF_MOVE(result) | parse_cat();
+			}
+			return result;
+		}
+
+		chef::re parse_cat()
+		{
+			chef::re result(""s);
+			while (!at_end() && peek() != '|' && peek() != ')') {
+				result = CHEF_MOVE(result) << parse_star();
+			}
+			return result;
+		}
+
+		chef::re parse_star()
+		{
+			chef::re result = parse_atom();
+			while (!at_end() && peek() == '*') {
+				++pos;
+				result = *CHEF_MOVE(result);
+			}
+			return result;
+		}
+
+		chef::re parse_atom()
+		{
+			switch (char const c = pattern[pos++]) {
+			case '(': {
+				chef::re result = parse_union();
+				if (at_end() || peek() != ')') {
+					fail("expected `)`");
+				}
+				++pos;
+				return result;
+			}
+			case '*':
+				--pos;
+				fail("`*` must follow an expression");
+			case '\\':
+				if (at_end()) {
+					fail("dangling `\\`");
+				}
+				return chef::re(std::string(1, pattern[pos++]));
+			default:
+				return chef::re(std::string(1, c));
+			}
+		}
+	};
+}
+
+namespace chef {
+	auto parse_re(std::string_view pattern) -> chef::re
+	{
+		return ::parser(pattern).parse();
+	}
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string_view>
+
+#include <chef/re/re.hpp>
+
+namespace chef {
+	// Parses the textual form of a regular expression.
+	//
+	// Syntax (loosest binding first):
+	//  - `a|b`: union
+	//  - `ab`: concatenation
+	//  - `a*`: kleene star
+	//  - `(a)`: grouping
+	//  - `\c`: the character c, even if it is one of the special characters `|*()\`
+	//
+	// An empty alternative such as `a|` or `()` is the empty string.
+	//
+	// Throws chef::construction_error if the expression is malformed.
+	auto parse_re(std::string_view pattern) -> chef::re;
+}
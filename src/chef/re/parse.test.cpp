@@ -0,0 +1,42 @@
+#include "./parse.hpp"
+
+#include <chef/errors.hpp>
+#include <chef/re/engines/derivative.hpp>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("re parses literals, unions, stars and groups")
+{
+	CHECK(chef::parse_re("abc").to_string() == "abc");
+	CHECK(chef::parse_re("ab|c").to_string() == "ab|c");
+	CHECK(chef::parse_re("a(b|c)").to_string() == "a(b|c)");
+	CHECK(chef::parse_re("(a|b)*").to_string() == "(a|b)*");
+	CHECK(chef::parse_re("a(b|c)*").to_string() == "a(b|c)*");
+}
+
+TEST_CASE("re parses escapes and empty alternatives")
+{
+	chef::re const re = chef::parse_re("\\(\\*|");
+
+	CHECK(chef::re_derivative_engine::matches(re, "(*"));
+	CHECK(chef::re_derivative_engine::matches(re, ""));
+	CHECK_FALSE(chef::re_derivative_engine::matches(re, "("));
+}
+
+TEST_CASE("re parsing matches the constructed re")
+{
+	chef::re const re = chef::parse_re("(Hello, World!|(a(b|c))*)*");
+
+	CHECK(chef::re_derivative_engine::matches(re, ""));
+	CHECK(chef::re_derivative_engine::matches(re, "Hello, World!abacHello, World!"));
+	CHECK_FALSE(chef::re_derivative_engine::matches(re, "a"));
+}
+
+TEST_CASE("re parsing rejects malformed expressions")
+{
+	CHECK_THROWS_AS(chef::parse_re("(a"), chef::construction_error);
+	CHECK_THROWS_AS(chef::parse_re("a)"), chef::construction_error);
+	CHECK_THROWS_AS(chef::parse_re("*a"), chef::construction_error);
+	CHECK_THROWS_AS(chef::parse_re("a|*"), chef::construction_error);
+	CHECK_THROWS_AS(chef::parse_re("a\\"), chef::construction_error);
+}
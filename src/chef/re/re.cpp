@@ -31,7 +31,8 @@ namespace chef {
 
 								  for (auto const& sub : re.pieces) {
 									  bool const needs_parens
-										  = std::holds_alternative<chef::re_union>(sub->value);
+										  = std::holds_alternative<chef::re_union>(sub->value)
+										  || std::holds_alternative<chef::re_and>(sub->value);
 									  if (needs_parens) out << '(';
 									  out << sub->to_string();
 									  if (needs_parens) out << ')';
@@ -45,6 +46,27 @@ namespace chef {
 								  if (needs_parens) return '(' + re.value->to_string() + ")*";
 								  return re.value->to_string() + '*';
 							  },
+							  [](chef::re_and const& re) {
+								  std::ostringstream out;
+								  bool first = true;
+
+								  for (auto const& sub : re.pieces) {
+									  if (!first) {
+										  out << '&';
+									  }
+									  first = false;
+									  bool const needs_parens
+										  = std::holds_alternative<chef::re_union>(sub->value);
+									  if (needs_parens) out << '(';
+									  out << sub->to_string();
+									  if (needs_parens) out << ')';
+								  }
+
+								  return out.str();
+							  },
+							  [](chef::re_not const& re) {
+								  return "~(" + re.value->to_string() + ')';
+							  },
 							  [](chef::re_lit const& re) { return re.value; },
 							  [](chef::re_empty const&) { return "<EMPTY>"s; },
 							  [](chef::re_char_class const&) { return "[]"s; },
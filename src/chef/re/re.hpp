@@ -39,10 +39,20 @@ namespace chef {
 
 	struct re_char_class { };
 
+	// The strings which every piece matches.
+	struct re_and {
+		std::vector<chef::detail::value_ptr<re>> pieces;
+	};
+
+	// The strings which the value does not match.
+	struct re_not {
+		chef::detail::value_ptr<re> value;
+	};
+
 	class re {
 	private:
-		using variant_type
-			= std::variant<re_empty, re_cat, re_union, re_lit, re_star, re_char_class>;
+		using variant_type = std::variant<re_empty, re_cat, re_union, re_lit, re_star,
+			re_char_class, re_and, re_not>;
 
 	public:
 		variant_type value;
@@ -136,6 +146,49 @@ namespace chef {
 				CHEF_MOVE(lhs.value), CHEF_MOVE(rhs.value));
 		}
 
+		friend re operator&(re lhs, re rhs)
+		{
+			return std::visit(
+				detail::overload{
+					[](re_and lhs, re_and rhs) -> re {
+						lhs.pieces.insert(lhs.pieces.end(), std::move_iterator(rhs.pieces.begin()),
+							std::move_iterator(rhs.pieces.end()));
+						return re(CHEF_MOVE(lhs));
+					},
+					[](re_and lhs, detail::IsNot<re_empty> auto rhs) -> re {
+						lhs.pieces.emplace_back(std::make_unique<re>(CHEF_MOVE(rhs)));
+						return re(CHEF_MOVE(lhs));
+					},
+					[](detail::IsNot<re_empty> auto lhs, re_and rhs) -> re {
+						rhs.pieces.emplace(
+							rhs.pieces.begin(), std::make_unique<re>(CHEF_MOVE(lhs)));
+						return re(CHEF_MOVE(rhs));
+					},
+					[](detail::IsNot<re_empty> auto lhs, detail::IsNot<re_empty> auto rhs) -> re {
+						re_and result;
+						result.pieces.emplace_back(std::make_unique<re>(CHEF_MOVE(lhs)));
+						result.pieces.emplace_back(std::make_unique<re>(CHEF_MOVE(rhs)));
+						return re(CHEF_MOVE(result));
+					},
+					[](re_empty, auto&&) -> re { return re(re_empty{}); },
+					[](auto&&, re_empty) -> re { return re(re_empty{}); },
+					[](re_empty, re_empty) -> re { return re(re_empty{}); },
+				},
+				CHEF_MOVE(lhs.value), CHEF_MOVE(rhs.value));
+		}
+
+		re operator~() const&
+		{
+			if (auto const* inner = std::get_if<re_not>(&value)) return *inner->value;
+			return re(re_not{chef::detail::value_ptr<re>(std::make_unique<re>(*this))});
+		}
+
+		re operator~() &&
+		{
+			if (auto* inner = std::get_if<re_not>(&value)) return CHEF_MOVE(*inner->value);
+			return re(re_not{chef::detail::value_ptr<re>(std::make_unique<re>(CHEF_MOVE(value)))});
+		}
+
 		re operator*() const&
 		{
 			if (std::holds_alternative<re_empty>(value)) return *this;
@@ -165,6 +218,11 @@ namespace chef {
 									  return std::any_of(alt.pieces.begin(), alt.pieces.end(),
 										  [] TL(_1->is_vanishable()));
 								  },
+								  [](re_and const& both) {
+									  return std::all_of(both.pieces.begin(), both.pieces.end(),
+										  [] TL(_1->is_vanishable()));
+								  },
+								  [](re_not const& re) { return !re.value->is_vanishable(); },
 								  [](auto const&) { return false; },
 							  },
 				value);
@@ -201,6 +259,15 @@ namespace chef {
 											  return re_p->accumulate_chars(CHEF_MOVE(init), acc);
 										  });
 								  },
+								  [&](re_and const& both) {
+									  return std::accumulate(both.pieces.begin(), both.pieces.end(),
+										  CHEF_MOVE(init), [&acc](T&& init, auto const& re_p) {
+											  return re_p->accumulate_chars(CHEF_MOVE(init), acc);
+										  });
+								  },
+								  [&](re_not const& re) {
+									  return re.value->accumulate_chars(CHEF_MOVE(init), acc);
+								  },
 								  [&](re_char_class) { return CHEF_MOVE(init); },
 							  },
 				value);
@@ -55,3 +55,24 @@ TEST_CASE("re star starring yields a single star")
 	CHECK(std::holds_alternative<chef::re_char_class>(
 		std::get<chef::re_star>(star.value).value->value));
 }
+
+TEST_CASE("re intersection yields a single intersection")
+{
+	const chef::re both = chef::re(chef::re_char_class{}) & chef::re(chef::re_char_class{})
+		& chef::re(chef::re_char_class{});
+	REQUIRE(std::holds_alternative<chef::re_and>(both.value));
+	CHECK(std::get<chef::re_and>(both.value).pieces.size() == 3);
+
+	CHECK(std::holds_alternative<chef::re_empty>((chef::re() & chef::re("a")).value));
+}
+
+TEST_CASE("re complement of a complement is the original")
+{
+	const chef::re negated = ~chef::re("a");
+	REQUIRE(std::holds_alternative<chef::re_not>(negated.value));
+	CHECK(negated.is_vanishable());
+
+	const chef::re twice = ~negated;
+	REQUIRE(std::holds_alternative<chef::re_lit>(twice.value));
+	CHECK(std::get<chef::re_lit>(twice.value).value == "a");
+}
@@ -1,204 +1,218 @@
 #pragma once
 
 #include <algorithm>
+#include <cassert>
 #include <functional>
-#include <iterator>
+#include <limits>
 #include <numeric>
 #include <ranges>
+#include <span>
+#include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include <chef/_/fwd.hpp>
 #include <chef/_/overload.hpp>
+#include <chef/budget.hpp>
+#include <chef/dfa/convert.hpp>
+#include <chef/dfa/dfa.hpp>
+#include <chef/dfa/minimize.hpp>
 #include <chef/dfa/nfa.hpp>
+#include <chef/dfa/product.hpp>
+#include <chef/dfa/stats.hpp>
 #include <chef/re/re.hpp>
 #include <tl/tl.hpp>
 
 namespace chef {
 	namespace detail {
-		inline std::pair<nfa, std::unordered_set<chef::state_type>> to_nfa(
-			chef::re const& re, std::unordered_map<char, chef::symbol_type> const& symbol_map)
+		// The number of symbols, where several characters may share a symbol.
+		inline auto num_symbols(std::unordered_map<char, chef::symbol_type> const& symbol_map)
+			-> chef::symbol_type
 		{
-			const chef::symbol_type num_symbols
-				= static_cast<chef::symbol_type>(symbol_map.size()) + 1;
-
-			return std::visit(
-				detail::overload{
-					[&](re_union const& re) {
-						std::vector<std::pair<nfa, std::unordered_set<chef::state_type>>> nfas;
-						nfas.reserve(re.pieces.size());
-						std::ranges::transform(re.pieces,
-							std::back_inserter(nfas), [&] TL(detail::to_nfa(*_1, symbol_map)));
-
-						const chef::state_type num_states = 1
-							+ std::transform_reduce(nfas.begin(), nfas.end(), chef::state_type(0),
-								std::plus<>{}, [] TL(_1.first.num_states()));
-
-						std::vector<fa_edge> edge_list;
-
-						std::unordered_set<chef::state_type> accepts;
-						accepts.reserve(std::transform_reduce(nfas.begin(), nfas.end(),
-							std::size_t(0), std::plus<>{}, [] TL(_1.second.size())));
-
-						chef::state_type offset = 1; // state 0 is the initial state
-						for (auto const& [cur, cur_accepts] : nfas) {
-							edge_list.push_back(fa_edge{
-								.from = 0,
-								.to = offset, // this alternative's "initial" state
-								.on = chef::nfa::eps,
-							});
-							for (const chef::state_type from : cur.states()) {
-								for (const chef::symbol_type sym : cur.symbols()) {
-									for (const chef::state_type to : cur.process(from, sym)) {
-										edge_list.push_back(fa_edge{
-											.from = from + offset,
-											.to = to + offset,
-											.on = sym,
-										});
-									}
-								}
-							}
+			chef::symbol_type result = 0;
+			for (auto const& [c, symbol] : symbol_map) {
+				result = std::max<chef::symbol_type>(result, symbol + 1);
+			}
+			return result;
+		}
 
-							std::ranges::transform(cur_accepts,
-								std::inserter(accepts, accepts.end()), [=] TL(_1 + offset));
+		// Builds a Thompson NFA in a single pass over the RE, appending states and edges to one
+		// edge list rather than building an NFA for each sub-expression.
+		class thompson_builder {
+		public:
+			// A piece of the NFA with one initial state and one accepting state.
+			struct fragment {
+				chef::state_type start;
+				chef::state_type accept;
+			};
 
-							offset += cur.num_states();
-						}
+		private:
+			std::unordered_map<char, chef::symbol_type> const* symbol_map_;
+			// The DFAs built for & and ~ are counted against it.
+			detail::budget_meter* meter_;
+			std::vector<fa_edge> edge_list_;
+			chef::state_type num_states_ = 0;
 
-						return std::pair{
-							nfa(num_states, num_symbols, edge_list),
-							CHEF_MOVE(accepts),
-						};
-					},
-					[&](re_cat const& re) {
-						std::vector<std::pair<nfa, std::unordered_set<chef::state_type>>> nfas;
-						nfas.reserve(re.pieces.size());
-						std::ranges::transform(re.pieces,
-							std::back_inserter(nfas), [&] TL(detail::to_nfa(*_1, symbol_map)));
-
-						const chef::state_type num_states
-							= std::transform_reduce(nfas.begin(), nfas.end(), chef::state_type(0),
-								std::plus<>{}, [] TL(_1.first.num_states()));
-
-						std::vector<fa_edge> edge_list;
-
-						std::unordered_set<chef::state_type> last_accepts;
-
-						chef::state_type offset = 0; // state 0 is the initial state
-						for (auto&& [cur, cur_accepts] : nfas) {
-							std::ranges::transform(last_accepts, std::back_inserter(edge_list),
-								[=] TL(fa_edge{
-									.from = _1,
-									.to = offset, // this section's "initial" state
-									.on = chef::nfa::eps,
-								}));
-
-							for (const chef::state_type from : cur.states()) {
-								for (const chef::symbol_type sym : cur.symbols()) {
-									for (const chef::state_type to : cur.process(from, sym)) {
-										edge_list.push_back(fa_edge{
-											.from = from + offset,
-											.to = to + offset,
-											.on = sym,
-										});
-									}
-								}
+		public:
+			explicit thompson_builder(std::unordered_map<char, chef::symbol_type> const& symbol_map,
+				detail::budget_meter& meter)
+				: symbol_map_(&symbol_map)
+				, meter_(&meter)
+			{ }
+
+			auto new_state() -> chef::state_type
+			{
+				return num_states_++;
+			}
+
+			void add_eps(chef::state_type from, chef::state_type to)
+			{
+				edge_list_.push_back(fa_edge{.from = from, .to = to, .on = chef::nfa::eps});
+			}
+
+			auto add(chef::re const& re) -> fragment
+			{
+				return std::visit(
+					detail::overload{
+						[&](re_union const& re) {
+							fragment const result{.start = new_state(), .accept = 0};
+							std::vector<chef::state_type> accepts;
+							accepts.reserve(re.pieces.size());
+							for (auto const& piece : re.pieces) {
+								fragment const cur = add(*piece);
+								add_eps(result.start, cur.start);
+								accepts.push_back(cur.accept);
 							}
 
-							last_accepts.clear();
-							std::ranges::transform(cur_accepts,
-								std::inserter(last_accepts, last_accepts.end()),
-								[=] TL(_1 + offset));
+							chef::state_type const accept = new_state();
+							for (chef::state_type const from : accepts) {
+								add_eps(from, accept);
+							}
+							return fragment{.start = result.start, .accept = accept};
+						},
+						[&](re_cat const& re) {
+							if (re.pieces.empty()) {
+								chef::state_type const state = new_state();
+								return fragment{.start = state, .accept = state};
+							}
 
-							offset += cur.num_states();
-						}
+							fragment result = add(*re.pieces.front());
+							for (auto const& piece : re.pieces | std::views::drop(1)) {
+								fragment const cur = add(*piece);
+								add_eps(result.accept, cur.start);
+								result.accept = cur.accept;
+							}
+							return result;
+						},
+						[&](re_star const& re) {
+							chef::state_type const start = new_state();
+							fragment const value = add(*re.value);
+							chef::state_type const accept = new_state();
 
-						return std::pair{
-							nfa(num_states, num_symbols, edge_list),
-							CHEF_MOVE(last_accepts),
-						};
+							add_eps(start, value.start);
+							add_eps(start, accept);
+							// The back edge
+							add_eps(value.accept, value.start);
+							add_eps(value.accept, accept);
+							return fragment{.start = start, .accept = accept};
+						},
+						[&](re_lit const& re) {
+							chef::state_type const start = new_state();
+							chef::state_type last = start;
+							for (char const c : re.value) {
+								chef::state_type const next = new_state();
+								edge_list_.push_back(fa_edge{
+									.from = last,
+									.to = next,
+									.on = chef::symbol_type(symbol_map_->at(c) + 1),
+								});
+								last = next;
+							}
+							return fragment{.start = start, .accept = last};
+						},
+						[&](re_empty) {
+							// Nothing reaches the accepting state.
+							chef::state_type const start = new_state();
+							return fragment{.start = start, .accept = new_state()};
+						},
+						[&](re_and const& re) {
+							auto [dfa, categories] = to_min_dfa(*re.pieces.front());
+							for (auto const& piece : re.pieces | std::views::drop(1)) {
+								auto const [rhs, rhs_categories] = to_min_dfa(*piece);
+								std::tie(dfa, categories) = detail::product(dfa, categories[0], rhs,
+									rhs_categories[0], std::logical_and(), *meter_);
+							}
+							return add(dfa, categories[0]);
+						},
+						[&](re_not const& re) {
+							auto const [dfa, categories] = to_min_dfa(*re.value);
+							auto const [complement, complement_categories]
+								= chef::complement(dfa, categories[0]);
+							return add(complement, complement_categories[0]);
+						},
+						[&](re_char_class) -> fragment { throw 1; },
 					},
-					[&](re_star const& re) {
-						auto [value, accepts] = detail::to_nfa(*re.value, symbol_map);
+					re.value);
+			}
 
-						const chef::state_type num_states = 2 + value.num_states();
-						const chef::state_type last = num_states - 1;
+			// Adds a copy of the DFA, whose symbols are numbered by the symbol map.
+			auto add(chef::dfa const& dfa, chef::category_view accepts)
+				-> fragment
+			{
+				chef::state_type const first = num_states_;
+				num_states_ += dfa.num_states();
+				for (chef::state_type const from : dfa.states()) {
+					for (chef::symbol_type const on : dfa.symbols()) {
+						chef::state_type const to = dfa.process(from, on);
+						if (to == dfa.dead_state()) continue;
+						edge_list_.push_back(fa_edge{
+							.from = first + from,
+							.to = first + to,
+							.on = chef::symbol_type(on + 1),
+						});
+					}
+				}
 
-						std::vector<fa_edge> edge_list;
+				chef::state_type const accept = new_state();
+				for (chef::state_type const state : accepts) {
+					add_eps(first + state, accept);
+				}
+				return fragment{.start = first, .accept = accept};
+			}
 
-						edge_list.push_back(fa_edge{
-							.from = 0,
-							.to = 1,
-							.on = chef::nfa::eps,
-						});
-						edge_list.push_back(fa_edge{
-							.from = 0,
-							.to = last,
-							.on = chef::nfa::eps,
-						});
+			auto finish() && -> chef::nfa
+			{
+				return chef::nfa(num_states_, detail::num_symbols(*symbol_map_) + 1, edge_list_);
+			}
 
-						for (const chef::state_type from : value.states()) {
-							for (const chef::symbol_type sym : value.symbols()) {
-								for (const chef::state_type to : value.process(from, sym)) {
-									edge_list.push_back(fa_edge{
-										.from = from + 1,
-										.to = to + 1,
-										.on = sym,
-									});
-								}
-							}
-						}
+		private:
+			// & and ~ have no Thompson construction, so their operands are built separately into
+			// minimal DFAs, combined, and then copied in whole.
+			auto to_min_dfa(chef::re const& re) const
+				-> std::pair<chef::dfa, chef::state_categories>
+			{
+				thompson_builder builder(*symbol_map_, *meter_);
+				chef::state_type const accept = builder.add(re).accept;
+				auto const [dfa, categories] = chef::to_dfa(CHEF_MOVE(builder).finish(), {{accept}},
+					chef::dfa_kind::partial, nullptr, *meter_);
+				return chef::minimize(dfa, categories);
+			}
+		};
 
-						for (const chef::state_type accept : accepts) {
-							// The back edge
-							edge_list.push_back(fa_edge{
-								.from = accept + 1,
-								.to = 1,
-								.on = chef::nfa::eps,
-							});
-							edge_list.push_back(fa_edge{
-								.from = accept + 1,
-								.to = last,
-								.on = chef::nfa::eps,
-							});
-						}
-
-						return std::pair{
-							nfa(num_states, num_symbols, edge_list),
-							std::unordered_set({last}),
-						};
-					},
-					[&](re_lit const& re) {
-						const chef::state_type num_states = chef::state_type(re.value.size()) + 1;
-
-						std::vector<fa_edge> edge_list;
-						edge_list.reserve(re.value.size());
-
-						for (auto const index : detail::indices<chef::state_type>(re.value)) {
-							edge_list.push_back(fa_edge{
-								.from = index,
-								.to = index + 1,
-								.on = chef::symbol_type(symbol_map.at(re.value[index]) + 1),
-							});
-						}
-
-						return std::pair{
-							nfa(num_states, num_symbols, edge_list),
-							std::unordered_set({chef::state_type(num_states - 1)}),
-						};
-					},
-					[&](re_empty) {
-						return std::pair{
-							nfa(1, num_symbols, {}),
-							std::unordered_set<chef::state_type>(),
-						};
-					},
-					[&](re_char_class) -> std::pair<nfa, std::unordered_set<chef::state_type>> {
-						throw 1;
-					},
-				},
-				re.value);
+		inline std::pair<nfa, std::unordered_set<chef::state_type>> to_nfa(chef::re const& re,
+			std::unordered_map<char, chef::symbol_type> const& symbol_map,
+			detail::budget_meter& meter)
+		{
+			thompson_builder builder(symbol_map, meter);
+			auto const [start, accept] = builder.add(re);
+			assert(start == 0);
+
+			return std::pair{
+				CHEF_MOVE(builder).finish(),
+				std::unordered_set({accept}),
+			};
 		}
 	}
 
@@ -208,19 +222,109 @@ namespace chef {
 		std::unordered_map<char, chef::symbol_type> symbol_map;
 	};
 
-	inline nfa_conversion_result_t to_nfa(chef::re const& re)
+	namespace detail {
+		inline std::unordered_map<char, chef::symbol_type> add_to_symbol_map(
+			std::unordered_map<char, chef::symbol_type> symbol_map, chef::re const& re)
+		{
+			return re.accumulate_chars(CHEF_MOVE(symbol_map),
+				[](std::unordered_map<char, chef::symbol_type> acc, char const val) {
+					acc.emplace(val, acc.size());
+					return acc;
+				});
+		}
+
+		inline bool has_complement(chef::re const& re)
+		{
+			auto const any = [](auto const& pieces) {
+				return std::ranges::any_of(pieces, [] TL(detail::has_complement(*_1)));
+			};
+			return std::visit(detail::overload{
+								  [](re_not const&) { return true; },
+								  [](re_star const& re) {
+									  return detail::has_complement(*re.value);
+								  },
+								  [&](re_cat const& re) { return any(re.pieces); },
+								  [&](re_union const& re) { return any(re.pieces); },
+								  [&](re_and const& re) { return any(re.pieces); },
+								  [](auto const&) { return false; },
+							  },
+				re.value);
+		}
+
+		// The complement of an RE includes strings of characters which the RE never mentions, so
+		// every other character is given one shared symbol.
+		inline std::unordered_map<char, chef::symbol_type> add_other_symbol(
+			std::unordered_map<char, chef::symbol_type> symbol_map)
+		{
+			chef::symbol_type const other = detail::num_symbols(symbol_map);
+			for (int c = std::numeric_limits<char>::min(); c <= std::numeric_limits<char>::max();
+				 ++c)
+			{
+				symbol_map.emplace(static_cast<char>(c), other);
+			}
+			return symbol_map;
+		}
+	}
+
+	// With `stats`, the time taken and the size of the NFA are recorded. The DFAs built for &
+	// and ~ are kept to the budget, and going over it throws a chef::construction_budget_error.
+	inline nfa_conversion_result_t to_nfa(chef::re const& re,
+		chef::construction_stats* stats = nullptr, chef::budget const& budget = {})
 	{
-		auto symbol_map = re.accumulate_chars(std::unordered_map<char, chef::symbol_type>(),
-			[](std::unordered_map<char, chef::symbol_type> acc, char const val) {
-				acc.emplace(val, acc.size());
-				return acc;
-			});
+		detail::phase_timer const timer(stats, &chef::construction_stats::to_nfa_time);
+		detail::budget_meter meter(budget);
+		auto symbol_map = detail::add_to_symbol_map({}, re);
+		if (detail::has_complement(re)) {
+			symbol_map = detail::add_other_symbol(CHEF_MOVE(symbol_map));
+		}
 
-		auto [nfa, accepts] = detail::to_nfa(re, symbol_map);
+		auto [nfa, accepts] = detail::to_nfa(re, symbol_map, meter);
+		if (stats) stats->nfa_states = nfa.num_states();
 		return nfa_conversion_result_t{
 			.nfa = CHEF_MOVE(nfa),
 			.accepts = CHEF_MOVE(accepts),
 			.symbol_map = CHEF_MOVE(symbol_map),
 		};
 	}
+
+	struct multi_nfa_conversion_result_t {
+		chef::nfa nfa;
+		// The accepting states of each RE, in the same order as the REs.
+		std::vector<std::unordered_set<chef::state_type>> categories;
+		std::unordered_map<char, chef::symbol_type> symbol_map;
+	};
+
+	// Converts several REs into one NFA which accepts any of them, such as for a lexer.
+	// Each RE's accepting states are kept as a separate category. The budget is as above.
+	inline multi_nfa_conversion_result_t to_nfa(std::span<chef::re const> res,
+		chef::construction_stats* stats = nullptr, chef::budget const& budget = {})
+	{
+		detail::phase_timer const timer(stats, &chef::construction_stats::to_nfa_time);
+		detail::budget_meter meter(budget);
+		auto symbol_map = std::accumulate(
+			res.begin(), res.end(), std::unordered_map<char, chef::symbol_type>(),
+			[] TL(detail::add_to_symbol_map(CHEF_MOVE(_1), _2)));
+		if (std::ranges::any_of(res, [] TL(detail::has_complement(_1)))) {
+			symbol_map = detail::add_other_symbol(CHEF_MOVE(symbol_map));
+		}
+
+		detail::thompson_builder builder(symbol_map, meter);
+		std::vector<std::unordered_set<chef::state_type>> categories;
+		categories.reserve(res.size());
+
+		chef::state_type const start = builder.new_state();
+		for (chef::re const& re : res) {
+			auto const cur = builder.add(re);
+			builder.add_eps(start, cur.start);
+			categories.push_back({cur.accept});
+		}
+
+		chef::nfa nfa = CHEF_MOVE(builder).finish();
+		if (stats) stats->nfa_states = nfa.num_states();
+		return multi_nfa_conversion_result_t{
+			.nfa = CHEF_MOVE(nfa),
+			.categories = CHEF_MOVE(categories),
+			.symbol_map = CHEF_MOVE(symbol_map),
+		};
+	}
 }
@@ -0,0 +1,43 @@
+#include <chef/re/to_nfa.hpp>
+
+#include <string>
+
+#include <chef/re/engines/dfa.hpp>
+#include <chef/re/parse.hpp>
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("re -> nfa gives each fragment one accepting state")
+{
+	auto const [nfa, accepts, symbol_map] = chef::to_nfa(chef::parse_re("ab|c*"));
+
+	// union: 2, "ab": 3, star: 2, "c": 2
+	CHECK(nfa.num_states() == 9);
+	CHECK(accepts.size() == 1);
+	CHECK(symbol_map.size() == 3);
+}
+
+TEST_CASE("re -> nfa is linear in the nesting depth")
+{
+	// ((((a|b)c|b)c|b)c ...
+	std::string pattern = "a";
+	for (int i = 0; i < 1000; ++i) {
+		pattern = "(" + pattern + "|b)c";
+	}
+	chef::re const re = chef::parse_re(pattern);
+
+	// Each level adds a union (2 states) and the literals "b" and "c" (2 states each).
+	CHECK(chef::to_nfa(re).nfa.num_states() == 2 + 1000 * 6);
+}
+
+TEST_CASE("re -> nfa keeps the language of nested expressions")
+{
+	chef::re const re = chef::parse_re("((a|)(b*|c))*d");
+
+	CHECK(chef::re_dfa_engine::matches(re, "d"));
+	CHECK(chef::re_dfa_engine::matches(re, "abbbcd"));
+	CHECK(chef::re_dfa_engine::matches(re, "ccd"));
+	CHECK(chef::re_dfa_engine::matches(re, "bcaad"));
+	CHECK_FALSE(chef::re_dfa_engine::matches(re, ""));
+	CHECK_FALSE(chef::re_dfa_engine::matches(re, "da"));
+}